@@ -0,0 +1,10 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef SHIM_HARDWARE_CLOCKS_H
+#define SHIM_HARDWARE_CLOCKS_H
+
+#include "pico_shim.h"
+
+#endif
@@ -0,0 +1,10 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef SHIM_PICO_TYPES_H
+#define SHIM_PICO_TYPES_H
+
+#include "pico_shim.h"
+
+#endif
@@ -0,0 +1,298 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Host (Linux) stand-in for the parts of the Pico SDK used by ws2812.c.
+ *
+ * Time is virtual: sleeps, alarms, DMA transfers and PIO output advance a
+ * microsecond counter instead of waiting, so patterns run as fast as the
+ * host can render them. Words written to a state machine are recorded.
+ */
+
+#ifndef PICO_SHIM_H
+#define PICO_SHIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PICO_NO_HARDWARE            0
+#define PICO_PIO_VERSION            0
+#define PICO_ERROR_TIMEOUT          (-1)
+#define NUM_PIOS                    2
+#define NUM_PIO_STATE_MACHINES      4
+#define NUM_DMA_CHANNELS            12
+
+#define __not_in_flash(group)
+#define __not_in_flash_func(func)   func
+#define __time_critical_func(func)  func
+
+typedef unsigned int uint;
+typedef volatile uint32_t io_rw_32;
+
+// ---------------------------------------------------------------- time --
+
+typedef uint64_t absolute_time_t;
+typedef int32_t alarm_id_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void *user_data);
+
+absolute_time_t get_absolute_time(void);
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void sleep_until(absolute_time_t t);
+void busy_wait_us(uint64_t us);
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past);
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past);
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past);
+bool cancel_alarm(alarm_id_t alarm_id);
+
+static inline uint64_t to_us_since_boot(absolute_time_t t) {
+    return t;
+}
+
+static inline absolute_time_t from_us_since_boot(uint64_t us) {
+    return us;
+}
+
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) {
+    return t + us;
+}
+
+static inline absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms) {
+    return t + (uint64_t) ms * 1000u;
+}
+
+static inline absolute_time_t make_timeout_time_us(uint64_t us) {
+    return get_absolute_time() + us;
+}
+
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) {
+    return get_absolute_time() + (uint64_t) ms * 1000u;
+}
+
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t) (to - from);
+}
+
+// ------------------------------------------------------- sync and stdio --
+
+void __wfe(void);
+void __sev(void);
+void tight_loop_contents(void);
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+bool stdio_init_all(void);
+int getchar_timeout_us(uint32_t timeout_us);
+
+static inline uint get_core_num(void) {
+    return 0;
+}
+
+// ------------------------------------------------------------- clocks --
+
+enum clock_index {
+    clk_gpout0 = 0,
+    clk_ref = 4,
+    clk_sys = 5,
+    clk_peri = 6
+};
+
+uint32_t clock_get_hz(enum clock_index clk_index);
+
+// --------------------------------------------------------------- gpio --
+
+enum gpio_irq_level {
+    GPIO_IRQ_LEVEL_LOW = 0x1u,
+    GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL = 0x4u,
+    GPIO_IRQ_EDGE_RISE = 0x8u
+};
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_init(uint gpio);
+void gpio_pull_up(uint gpio);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback);
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms);
+
+// ---------------------------------------------------------------- irq --
+
+typedef void (*irq_handler_t)(void);
+
+enum irq_num {
+    TIMER_IRQ_0 = 0,
+    DMA_IRQ_0 = 11,
+    DMA_IRQ_1 = 12,
+    SHIM_NUM_IRQS = 32
+};
+
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_remove_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+
+// ---------------------------------------------------------------- pio --
+
+typedef struct pio_hw {
+    io_rw_32 txf[NUM_PIO_STATE_MACHINES];
+} pio_hw_t;
+
+typedef pio_hw_t *PIO;
+
+extern pio_hw_t shim_pio_hw[NUM_PIOS];
+#define pio0 (&shim_pio_hw[0])
+#define pio1 (&shim_pio_hw[1])
+
+enum pio_fifo_join {
+    PIO_FIFO_JOIN_NONE = 0,
+    PIO_FIFO_JOIN_TX = 1,
+    PIO_FIFO_JOIN_RX = 2
+};
+
+typedef struct pio_program {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+    uint8_t pio_version;
+} pio_program_t;
+
+typedef struct pio_sm_config {
+    uint32_t clkdiv_int;                // Integer part of the clock divider.
+    uint8_t clkdiv_frac;                // Fractional part in 1/256ths.
+    uint wrap_target;                   // Absolute wrap target.
+    uint wrap;                          // Absolute wrap source.
+    uint sideset_bit_count;             // Side-set bits including the enable bit.
+    bool sideset_optional;              // Side-set has an enable bit.
+    bool sideset_pindirs;               // Side-set drives pin directions.
+    uint sideset_base;                  // First side-set pin.
+    uint out_base;                      // First OUT pin.
+    uint out_count;                     // Number of OUT pins.
+    uint set_base;                      // First SET pin.
+    uint set_count;                     // Number of SET pins.
+    bool out_shift_right;               // OSR shifts right (LSB first).
+    bool autopull;                      // Refill the OSR automatically.
+    uint pull_threshold;                // Bits shifted before a refill.
+    enum pio_fifo_join fifo_join;       // FIFO joining.
+} pio_sm_config;
+
+pio_sm_config pio_get_default_sm_config(void);
+void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap);
+void sm_config_set_sideset(pio_sm_config *c, uint bit_count, bool optional, bool pindirs);
+void sm_config_set_sideset_pins(pio_sm_config *c, uint sideset_base);
+void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count);
+void sm_config_set_set_pins(pio_sm_config *c, uint set_base, uint set_count);
+void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold);
+void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join);
+void sm_config_set_clkdiv(pio_sm_config *c, float div);
+void sm_config_set_clkdiv_int_frac(pio_sm_config *c, uint16_t div_int, uint8_t div_frac);
+
+void pio_gpio_init(PIO pio, uint pin);
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx);
+uint pio_get_index(PIO pio);
+int pio_add_program(PIO pio, const pio_program_t *program);
+int pio_add_program_at_offset(PIO pio, const pio_program_t *program, uint offset);
+void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_unclaim(PIO pio, uint sm);
+bool pio_claim_free_sm_and_add_program_for_gpio_range(const pio_program_t *program, PIO *pio, uint *sm, uint *offset, uint gpio_base, uint gpio_count, bool set_gpio_base);
+void pio_remove_program_and_unclaim_sm(const pio_program_t *program, PIO pio, uint sm, uint offset);
+
+// ---------------------------------------------------------------- dma --
+
+#define DREQ_FORCE                  0x3f    // Unpaced, transfer as fast as possible.
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+typedef struct dma_channel_config {
+    enum dma_channel_transfer_size size;    // Transfer element size.
+    bool read_increment;                    // Read address increments.
+    bool write_increment;                   // Write address increments.
+    uint dreq;                              // Pacing request.
+    uint chain_to;                          // Channel triggered on completion.
+    uint ring_size_bits;                    // Address wrap, 0 for none.
+    bool ring_write;                        // Wrap applies to the write address.
+    bool bswap;                             // Reverse bytes in each word.
+    bool irq_quiet;                         // Suppress completion interrupts.
+    bool enable;                            // Channel enabled.
+} dma_channel_config;
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_claim(uint channel);
+void dma_channel_unclaim(uint channel);
+dma_channel_config dma_channel_get_default_config(uint channel);
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config *c, bool incr);
+void channel_config_set_write_increment(dma_channel_config *c, bool incr);
+void channel_config_set_dreq(dma_channel_config *c, uint dreq);
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to);
+void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits);
+void channel_config_set_bswap(dma_channel_config *c, bool bswap);
+void channel_config_set_irq_quiet(dma_channel_config *c, bool irq_quiet);
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr, const volatile void *read_addr, uint transfer_count, bool trigger);
+void dma_channel_set_config(uint channel, const dma_channel_config *config, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger);
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger);
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger);
+void dma_channel_start(uint channel);
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+void dma_channel_abort(uint channel);
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+bool dma_channel_get_irq0_status(uint channel);
+void dma_channel_acknowledge_irq0(uint channel);
+
+// ------------------------------------------------- shim control/record --
+
+/**
+ * @brief Called for every word a state machine pulls from its TX FIFO.
+ */
+typedef void (*shim_word_hook_t)(PIO pio, uint sm, uint64_t time_us, uint32_t word);
+
+/**
+ * @brief Shim run statistics.
+ */
+typedef struct shim_stats {
+    uint64_t now_us;                    // Virtual time.
+    uint64_t words;                     // Words sent to all state machines.
+    uint64_t frames;                    // Bursts separated by a latch gap.
+    uint64_t wire_us;                   // Time the state machines spent sending.
+    uint64_t presses;                   // Button presses delivered.
+    uint64_t dma_transfers;             // DMA transfers triggered.
+} shim_stats_t;
+
+void shim_set_run_limit_ms(uint64_t ms);
+void shim_set_press_interval_ms(uint64_t ms);
+void shim_set_keys(const char *keys, uint64_t interval_ms);
+void shim_set_sys_hz(uint32_t sys_hz);
+const uint16_t *shim_pio_get_instr(PIO pio);
+bool shim_pio_get_sm(PIO pio, uint sm, pio_sm_config *config, uint *initial_pc);
+void shim_set_word_hook(shim_word_hook_t hook);
+const shim_stats_t *shim_get_stats(void);
+void shim_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PICO_SHIM_H
+
+/* End. */
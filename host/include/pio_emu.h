@@ -0,0 +1,114 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Cycle accurate emulator for a single PIO state machine.
+ *
+ * Executes the assembled instructions with the configuration built by the
+ * *_program_init() functions: side-set, delay cycles, .wrap, autopull and the
+ * integer/fractional clock divider. Pin changes are reported as edges
+ * timestamped in nanoseconds of system time.
+ */
+
+#ifndef PIO_EMU_H
+#define PIO_EMU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pico_shim.h"
+
+#define PIO_EMU_INSTR_MEM   (32)
+#define PIO_EMU_FIFO_SIZE   (64)
+
+/**
+ * @brief Called when an output pin changes level.
+ */
+typedef void (*pio_emu_edge_t)(void *context, uint pin, bool level, uint64_t time_ns);
+
+/**
+ * @brief State machine state.
+ */
+typedef struct pio_emu {
+    uint16_t instr[PIO_EMU_INSTR_MEM];  // Instruction memory.
+    pio_sm_config config;               // State machine configuration.
+    uint32_t sys_hz;                    // System clock.
+    uint pc;                            // Program counter.
+    uint32_t x;                         // Scratch register X.
+    uint32_t y;                         // Scratch register Y.
+    uint32_t osr;                       // Output shift register.
+    uint osr_count;                     // Bits shifted out of the OSR.
+    uint32_t pins;                      // Output levels, one bit per GPIO.
+    uint delay;                         // Delay cycles still to run.
+    uint32_t fifo[PIO_EMU_FIFO_SIZE];   // TX FIFO (deeper than the hardware).
+    uint fifo_head;                     // Next word to pull.
+    uint fifo_count;                    // Words in the FIFO.
+    bool stalled;                       // Last cycle stalled.
+    uint64_t cycles;                    // State machine cycles run.
+    uint64_t sys_cycles;                // System clock cycles elapsed.
+    uint32_t frac_acc;                  // Fractional divider accumulator.
+    uint64_t pulls;                     // Words pulled from the FIFO.
+    uint64_t last_pull_sys_cycle;       // System cycle of the last pull.
+    bool fault;                         // Unsupported instruction seen.
+    pio_emu_edge_t edge;                // Edge callback.
+    void *context;                      // Edge callback context.
+} pio_emu_t;
+
+/**
+ * @brief Set up the emulator as pio_sm_init() would.
+ * 
+ * @param emu Emulator state.
+ * @param instr_mem The 32 words of PIO instruction memory.
+ * @param config State machine configuration.
+ * @param initial_pc Program entry point.
+ * @param sys_hz System clock frequency.
+ */
+void pio_emu_init(pio_emu_t *emu, const uint16_t *instr_mem, const pio_sm_config *config, uint initial_pc, uint32_t sys_hz);
+
+/**
+ * @brief Set the function called on every pin change.
+ * 
+ * @param emu Emulator state.
+ * @param edge Edge callback, or NULL for none.
+ * @param context Passed to the callback.
+ */
+void pio_emu_set_edge_callback(pio_emu_t *emu, pio_emu_edge_t edge, void *context);
+
+/**
+ * @brief Add a word to the TX FIFO.
+ * 
+ * @param emu Emulator state.
+ * @param word The word.
+ * @return true The word was queued.
+ * @return false The FIFO is full.
+ */
+bool pio_emu_push(pio_emu_t *emu, uint32_t word);
+
+/**
+ * @brief Run one state machine clock cycle.
+ * 
+ * @param emu Emulator state.
+ */
+void pio_emu_step(pio_emu_t *emu);
+
+/**
+ * @brief Run until the FIFO is empty and the state machine has stalled.
+ * 
+ * @param emu Emulator state.
+ * @param max_cycles Give up after this many state machine cycles.
+ * @return true The state machine stalled waiting for data.
+ * @return false The cycle limit was reached or an instruction is unsupported.
+ */
+bool pio_emu_run(pio_emu_t *emu, uint64_t max_cycles);
+
+/**
+ * @brief Convert system clock cycles to nanoseconds.
+ * 
+ * @param emu Emulator state.
+ * @param sys_cycles System clock cycles.
+ * @return uint64_t Nanoseconds.
+ */
+uint64_t pio_emu_ns(const pio_emu_t *emu, uint64_t sys_cycles);
+
+#endif // PIO_EMU_H
+
+/* End. */
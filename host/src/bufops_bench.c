@@ -0,0 +1,176 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Benchmarks the frame buffer fill, copy and mirror operations.
+ *
+ * The CPU versions are checked against a plain loop and timed on the host.
+ * The DMA versions are then checked through the shim, which runs them in
+ * virtual time, so only the estimate is given for them. The Cortex-M0+
+ * figures are estimates per word: loads and stores 2 cycles, ALU 1 cycle
+ * and a taken branch 2 cycles, while the DMA moves about one word a cycle
+ * with the CPU free.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "led_bufops.h"
+#include "led_patterns.h"
+
+#define M0_HZ (125000000.0)
+#define FILL_VALUE (0x00123456u)
+
+/**
+ * @brief Operation under test.
+ */
+typedef struct bench_op {
+    const char *name;                   // Operation name.
+    void (*run)(uint32_t *dst, const uint32_t *src, size_t count);
+    void (*expect)(uint32_t *dst, const uint32_t *src, size_t count);
+    double m0_cycles;                   // Estimated M0+ cycles per word.
+} bench_op_t;
+
+static void fill_loop(uint32_t *dst, const uint32_t *src, size_t count) {
+    led_array_set(dst, count, FILL_VALUE);
+}
+
+static void fill_ops(uint32_t *dst, const uint32_t *src, size_t count) {
+    led_bufops_fill(dst, FILL_VALUE, count);
+    led_bufops_wait();
+}
+
+static void copy_loop(uint32_t *dst, const uint32_t *src, size_t count) {
+    for (size_t idx = 0; idx < count; idx++) {
+        dst[idx] = src[idx];
+    }
+}
+
+static void copy_ops(uint32_t *dst, const uint32_t *src, size_t count) {
+    led_bufops_copy(dst, src, count);
+    led_bufops_wait();
+}
+
+static void mirror_loop(uint32_t *dst, const uint32_t *src, size_t count) {
+    for (size_t idx = 0; idx < count; idx++) {
+        dst[idx] = src[count - 1 - idx];
+    }
+}
+
+static void mirror_ops(uint32_t *dst, const uint32_t *src, size_t count) {
+    led_bufops_mirror(dst, src, count);
+}
+
+// Cycle estimates per word:
+//  fill loop    str, adds, cmp, bne
+//  fill cpu     4 x str, subs, bhs per 4 words
+//  copy loop    ldr, str, adds, cmp, bne
+//  copy cpu     ldmia/stmia of 4 words per pass
+//  mirror       ldr, str, subs, adds, cmp, bne
+static const bench_op_t cpu_ops[] = {
+    {"fill loop", fill_loop, fill_loop, 7.0},
+    {"fill cpu", fill_ops, fill_loop, 2.75},
+    {"copy loop", copy_loop, copy_loop, 9.0},
+    {"copy cpu", copy_ops, copy_loop, 3.0},
+    {"mirror cpu", mirror_ops, mirror_loop, 10.0},
+};
+static const bench_op_t dma_ops[] = {
+    {"fill dma", fill_ops, fill_loop, 1.0},
+    {"copy dma", copy_ops, copy_loop, 1.0},
+};
+
+/**
+ * @brief Monotonic time in nanoseconds.
+ */
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+/**
+ * @brief Check an operation against its plain loop.
+ * 
+ * @return true The results match.
+ */
+static bool check(const bench_op_t *op, uint32_t *dst, uint32_t *expect, const uint32_t *src, size_t count) {
+    memset(dst, 0xa5, count * sizeof(uint32_t));
+    memset(expect, 0xa5, count * sizeof(uint32_t));
+    op->run(dst, src, count);
+    op->expect(expect, src, count);
+    return memcmp(dst, expect, count * sizeof(uint32_t)) == 0;
+}
+
+/**
+ * @brief Program entry point.
+ */
+int main(int argc, char **argv) {
+    size_t count = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1000;
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [words]\n", argv[0]);
+        return 2;
+    }
+
+    uint32_t *src = malloc(count * sizeof(uint32_t));
+    uint32_t *dst = malloc(count * sizeof(uint32_t));
+    uint32_t *expect = malloc(count * sizeof(uint32_t));
+    uint32_t seed = 0x2545f491u;
+    for (size_t idx = 0; idx < count; idx++) {
+        seed = seed * 1664525u + 1013904223u;
+        src[idx] = seed >> 8;
+    }
+
+    printf("%zu words\n", count);
+    printf("%-12s %12s %14s %16s\n", "operation", "host ns/w", "est. M0+ c/w", "est. M0+ us/frame");
+    int status = 0;
+    for (size_t n = 0; n < sizeof(cpu_ops) / sizeof(cpu_ops[0]); n++) {
+        const bench_op_t *op = &cpu_ops[n];
+        if (check(op, dst, expect, src, count) == false) {
+            printf("%-12s  MISMATCH\n", op->name);
+            status = 1;
+            continue;
+        }
+
+        // Repeat until the run is long enough to time.
+        size_t reps = 1;
+        double elapsed;
+        for (;;) {
+            double start = now_ns();
+            for (size_t rep = 0; rep < reps; rep++) {
+                op->run(dst, src, count);
+                __asm__ volatile("" : : "r"(dst) : "memory");
+            }
+            elapsed = now_ns() - start;
+            if (elapsed > 2e8) {
+                break;
+            }
+            reps *= 2;
+        }
+        printf("%-12s %12.3f %14.2f %16.1f\n", op->name, elapsed / ((double) reps * (double) count), op->m0_cycles,
+            op->m0_cycles * (double) count / M0_HZ * 1e6);
+    }
+
+    // The DMA versions run through the shim, so are only checked.
+    if (led_bufops_init() == false) {
+        printf("no DMA channel\n");
+        status = 1;
+    }
+    for (size_t n = 0; n < sizeof(dma_ops) / sizeof(dma_ops[0]); n++) {
+        const bench_op_t *op = &dma_ops[n];
+        if (check(op, dst, expect, src, count) == false) {
+            printf("%-12s  MISMATCH\n", op->name);
+            status = 1;
+            continue;
+        }
+        printf("%-12s %12s %14.2f %16.1f\n", op->name, "-", op->m0_cycles, op->m0_cycles * (double) count / M0_HZ * 1e6);
+    }
+    led_bufops_deinit();
+
+    free(src);
+    free(dst);
+    free(expect);
+    return status;
+}
+
+/* End. */
@@ -0,0 +1,77 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Host entry point, sets up the shim and runs the firmware main().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico_shim.h"
+
+/**
+ * @brief The firmware main(), renamed by the host build.
+ */
+extern int ws2812_main(void);
+
+/**
+ * @brief Print the command line options.
+ * 
+ * @param name Program name.
+ */
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [--run-ms N] [--press-ms N] [--keys S] [--key-ms N] [--quiet]\n", name);
+    fprintf(stderr, "  --run-ms N    stop after N ms of virtual time (default 60000)\n");
+    fprintf(stderr, "  --press-ms N  press the mode button every N ms (default 10000, 0 for never)\n");
+    fprintf(stderr, "  --keys S      type the characters of S on the console, one at a time\n");
+    fprintf(stderr, "  --key-ms N    type the next key every N ms (default 15000)\n");
+    fprintf(stderr, "  --quiet       discard the firmware console output\n");
+}
+
+/**
+ * @brief Host program entry point.
+ * 
+ * @param argc Argument count.
+ * @param argv Arguments.
+ * @return int Exit status.
+ */
+int main(int argc, char **argv) {
+    uint64_t run_ms = 60000;
+    uint64_t press_ms = 10000;
+    const char *keys = "";
+    uint64_t key_ms = 15000;
+
+    for (int idx = 1; idx < argc; idx++) {
+        if (strcmp(argv[idx], "--run-ms") == 0 && idx + 1 < argc) {
+            run_ms = strtoull(argv[++idx], NULL, 0);
+        }
+        else if (strcmp(argv[idx], "--press-ms") == 0 && idx + 1 < argc) {
+            press_ms = strtoull(argv[++idx], NULL, 0);
+        }
+        else if (strcmp(argv[idx], "--keys") == 0 && idx + 1 < argc) {
+            keys = argv[++idx];
+        }
+        else if (strcmp(argv[idx], "--key-ms") == 0 && idx + 1 < argc) {
+            key_ms = strtoull(argv[++idx], NULL, 0);
+        }
+        else if (strcmp(argv[idx], "--quiet") == 0) {
+            if (freopen("/dev/null", "w", stdout) == NULL) {
+                perror("freopen");
+            }
+        }
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    shim_set_run_limit_ms(run_ms);
+    shim_set_press_interval_ms(press_ms);
+    shim_set_keys(keys, key_ms);
+
+    int ret = ws2812_main();
+    shim_report();
+    return ret;
+}
+
+/* End. */
@@ -0,0 +1,935 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Host (Linux) stand-in for the parts of the Pico SDK used by ws2812.c.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico_shim.h"
+#include "pio_emu.h"
+
+#define SHIM_SYS_HZ             (125000000u)    // Default RP2040 clk_sys.
+#define SHIM_CYCLES_PER_BIT     (10u)           // Used if the program cannot be emulated.
+#define SHIM_LATCH_NS           (50000u)        // Idle time that ends a frame.
+#define SHIM_MAX_ALARMS         (16)
+#define SHIM_MAX_IRQ_HANDLERS   (4)
+#define SHIM_INSTR_MEM          (32)
+#define SHIM_FOREVER            (UINT64_MAX)
+
+/**
+ * @brief State machine model, one word shifts out every word_ns.
+ */
+typedef struct shim_sm {
+    bool claimed;                       // Claimed by the application.
+    bool enabled;                       // Running.
+    pio_sm_config config;               // Configuration from pio_sm_init().
+    uint initial_pc;                    // Program entry point.
+    uint64_t word_ns;                   // Time to shift out one word.
+    uint64_t tx_done_ns;                // When the last queued word finishes.
+} shim_sm_t;
+
+/**
+ * @brief DMA channel model, transfers are performed when triggered.
+ */
+typedef struct shim_dma {
+    bool claimed;                       // Claimed by the application.
+    dma_channel_config config;          // Channel configuration.
+    const volatile void *read_addr;     // Next read address.
+    volatile void *write_addr;          // Next write address.
+    uint32_t trans_count;               // Transfers per trigger.
+    bool busy;                          // Transfer in progress.
+    uint64_t complete_ns;               // When the transfer completes.
+    bool irq0_enabled;                  // Raise DMA_IRQ_0 on completion.
+    bool irq0_status;                   // Raw interrupt status.
+} shim_dma_t;
+
+/**
+ * @brief Pending alarm.
+ */
+typedef struct shim_alarm {
+    alarm_id_t id;                      // Identifier, 0 when the slot is free.
+    uint64_t target_ns;                 // When to fire.
+    alarm_callback_t callback;          // Function to call.
+    void *user_data;                    // Passed to the callback.
+} shim_alarm_t;
+
+pio_hw_t shim_pio_hw[NUM_PIOS];
+
+// Operating data.
+static uint64_t                 shim_now_ns = 0;                // Virtual time.
+static uint32_t                 shim_sys_hz = SHIM_SYS_HZ;      // Emulated clk_sys.
+static uint64_t                 shim_limit_ns = SHIM_FOREVER;   // Stop when virtual time gets here.
+static uint64_t                 shim_press_ns = 0;              // Button press interval, 0 for none.
+static uint64_t                 shim_next_press_ns = SHIM_FOREVER;
+static const char               *shim_keys = "";                // Console keys still to type.
+static uint64_t                 shim_key_ns = 0;                // Console key interval.
+static uint64_t                 shim_next_key_ns = SHIM_FOREVER;
+static bool                     shim_event = false;             // __sev() latch.
+static uint32_t                 shim_irq_disabled = 0;          // Interrupts disabled.
+static bool                     shim_in_events = false;         // Running event handlers.
+static shim_sm_t                shim_sm[NUM_PIOS][NUM_PIO_STATE_MACHINES];
+static uint16_t                 shim_instr[NUM_PIOS][SHIM_INSTR_MEM];
+static uint32_t                 shim_instr_used[NUM_PIOS];
+static shim_dma_t               shim_dma[NUM_DMA_CHANNELS];
+static shim_alarm_t             shim_alarms[SHIM_MAX_ALARMS];
+static alarm_id_t               shim_next_alarm_id = 1;
+static irq_handler_t            shim_irq_handlers[SHIM_NUM_IRQS][SHIM_MAX_IRQ_HANDLERS];
+static bool                     shim_irq_enabled[SHIM_NUM_IRQS];
+static gpio_irq_callback_t      shim_gpio_callback = NULL;
+static uint                     shim_gpio_irq_pin = 0;
+static shim_word_hook_t         shim_word_hook = NULL;
+static shim_stats_t             shim_stats;
+static uint64_t                 shim_wire_ns = 0;               // Time spent shifting words out.
+static struct timespec          shim_wall_start;
+
+static void shim_dma_trigger(uint channel);
+
+// ---------------------------------------------------------- event loop --
+
+/**
+ * @brief Stop the run, reporting what happened.
+ */
+static void shim_finish(int status) {
+    fflush(stdout);
+    shim_report();
+    exit(status);
+}
+
+/**
+ * @brief Find the next pending event.
+ * 
+ * @return uint64_t Event time, or SHIM_FOREVER if nothing is pending.
+ */
+static uint64_t shim_next_event_ns(void) {
+    uint64_t next = shim_next_press_ns;
+    for (int idx = 0; idx < SHIM_MAX_ALARMS; idx++) {
+        if (shim_alarms[idx].id != 0 && shim_alarms[idx].target_ns < next) {
+            next = shim_alarms[idx].target_ns;
+        }
+    }
+    for (int idx = 0; idx < NUM_DMA_CHANNELS; idx++) {
+        if (shim_dma[idx].busy && shim_dma[idx].complete_ns < next) {
+            next = shim_dma[idx].complete_ns;
+        }
+    }
+    return next;
+}
+
+/**
+ * @brief Call the handlers for an interrupt.
+ */
+static void shim_raise_irq(uint num) {
+    if (num < SHIM_NUM_IRQS && shim_irq_enabled[num]) {
+        for (int idx = 0; idx < SHIM_MAX_IRQ_HANDLERS; idx++) {
+            if (shim_irq_handlers[num][idx] != NULL) {
+                shim_irq_handlers[num][idx]();
+            }
+        }
+    }
+    shim_event = true;
+}
+
+/**
+ * @brief Fire every event that is due at the current time.
+ */
+static void shim_run_events(void) {
+    if (shim_irq_disabled || shim_in_events) {
+        return;
+    }
+    shim_in_events = true;
+    bool fired = true;
+    while (fired) {
+        fired = false;
+        for (uint ch = 0; ch < NUM_DMA_CHANNELS; ch++) {
+            shim_dma_t *dma = &shim_dma[ch];
+            if (dma->busy && dma->complete_ns <= shim_now_ns) {
+                dma->busy = false;
+                fired = true;
+                if (dma->config.chain_to != ch) {
+                    shim_dma_trigger(dma->config.chain_to);
+                }
+                if (dma->config.irq_quiet == false) {
+                    dma->irq0_status = true;
+                    if (dma->irq0_enabled) {
+                        shim_raise_irq(DMA_IRQ_0);
+                    }
+                }
+            }
+        }
+        for (int idx = 0; idx < SHIM_MAX_ALARMS; idx++) {
+            shim_alarm_t *alarm = &shim_alarms[idx];
+            if (alarm->id != 0 && alarm->target_ns <= shim_now_ns) {
+                shim_alarm_t fire = *alarm;
+                alarm->id = 0;
+                fired = true;
+                int64_t again = fire.callback(fire.id, fire.user_data);
+                if (again != 0) {
+                    *alarm = fire;
+                    alarm->target_ns = (again > 0) ? fire.target_ns + (uint64_t) again * 1000u : shim_now_ns + (uint64_t) (-again) * 1000u;
+                }
+                shim_event = true;
+            }
+        }
+        if (shim_next_press_ns <= shim_now_ns) {
+            shim_next_press_ns += shim_press_ns;
+            fired = true;
+            shim_stats.presses++;
+            if (shim_gpio_callback != NULL) {
+                shim_gpio_callback(shim_gpio_irq_pin, GPIO_IRQ_LEVEL_LOW);
+            }
+            shim_event = true;
+        }
+    }
+    shim_in_events = false;
+}
+
+/**
+ * @brief Move virtual time forward, firing events in order.
+ * 
+ * @param target_ns The time to advance to.
+ */
+static void shim_advance_to(uint64_t target_ns) {
+    for (;;) {
+        uint64_t next = shim_irq_disabled ? SHIM_FOREVER : shim_next_event_ns();
+        uint64_t step = (next < target_ns) ? next : target_ns;
+        if (step > shim_limit_ns) {
+            shim_now_ns = shim_limit_ns;
+            shim_finish(0);
+        }
+        if (step > shim_now_ns) {
+            shim_now_ns = step;
+        }
+        if (next > target_ns) {
+            break;
+        }
+        shim_run_events();
+    }
+}
+
+// ---------------------------------------------------------------- time --
+
+absolute_time_t get_absolute_time(void) {
+    return shim_now_ns / 1000u;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t) (shim_now_ns / 1000u);
+}
+
+uint64_t time_us_64(void) {
+    return shim_now_ns / 1000u;
+}
+
+void sleep_us(uint64_t us) {
+    shim_advance_to(shim_now_ns + us * 1000u);
+}
+
+void sleep_ms(uint32_t ms) {
+    shim_advance_to(shim_now_ns + (uint64_t) ms * 1000000u);
+}
+
+void sleep_until(absolute_time_t t) {
+    if (t * 1000u > shim_now_ns) {
+        shim_advance_to(t * 1000u);
+    }
+}
+
+void busy_wait_us(uint64_t us) {
+    sleep_us(us);
+}
+
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    if (time * 1000u <= shim_now_ns) {
+        if (fire_if_past) {
+            callback(0, user_data);
+        }
+        return 0;
+    }
+    for (int idx = 0; idx < SHIM_MAX_ALARMS; idx++) {
+        if (shim_alarms[idx].id == 0) {
+            shim_alarms[idx].id = shim_next_alarm_id++;
+            shim_alarms[idx].target_ns = time * 1000u;
+            shim_alarms[idx].callback = callback;
+            shim_alarms[idx].user_data = user_data;
+            return shim_alarms[idx].id;
+        }
+    }
+    return -1;
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    return add_alarm_at(get_absolute_time() + us, callback, user_data, fire_if_past);
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    return add_alarm_in_us((uint64_t) ms * 1000u, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t alarm_id) {
+    for (int idx = 0; idx < SHIM_MAX_ALARMS; idx++) {
+        if (alarm_id != 0 && shim_alarms[idx].id == alarm_id) {
+            shim_alarms[idx].id = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ------------------------------------------------------- sync and stdio --
+
+void __wfe(void) {
+    if (shim_event) {
+        shim_event = false;
+        return;
+    }
+    uint64_t next = shim_next_event_ns();
+    if (next == SHIM_FOREVER) {
+        fprintf(stderr, "shim: __wfe() with nothing pending, the application would hang\n");
+        shim_finish(1);
+    }
+    shim_advance_to(next);
+    shim_event = false;
+}
+
+void __sev(void) {
+    shim_event = true;
+}
+
+void tight_loop_contents(void) {
+}
+
+uint32_t save_and_disable_interrupts(void) {
+    uint32_t status = shim_irq_disabled;
+    shim_irq_disabled = 1;
+    return status;
+}
+
+void restore_interrupts(uint32_t status) {
+    shim_irq_disabled = status;
+    if (shim_irq_disabled == 0) {
+        shim_run_events();
+    }
+}
+
+bool stdio_init_all(void) {
+    return true;
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    sleep_us(timeout_us);
+    if (*shim_keys == '\0' || shim_next_key_ns > shim_now_ns) {
+        return PICO_ERROR_TIMEOUT;
+    }
+    shim_next_key_ns += shim_key_ns;
+    return (unsigned char) *shim_keys++;
+}
+
+// ------------------------------------------------------ clocks and gpio --
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    return shim_sys_hz;
+}
+
+void gpio_init(uint gpio) {
+}
+
+void gpio_pull_up(uint gpio) {
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback) {
+    shim_gpio_callback = enabled ? callback : NULL;
+    shim_gpio_irq_pin = gpio;
+}
+
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms) {
+    fprintf(stderr, "shim: watchdog_reboot()\n");
+    shim_finish(0);
+}
+
+// ---------------------------------------------------------------- irq --
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+    for (int idx = 0; idx < SHIM_MAX_IRQ_HANDLERS; idx++) {
+        if (shim_irq_handlers[num][idx] == NULL) {
+            shim_irq_handlers[num][idx] = handler;
+            return;
+        }
+    }
+    fprintf(stderr, "shim: too many handlers for irq %u\n", num);
+    abort();
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    irq_add_shared_handler(num, handler, 0);
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler) {
+    for (int idx = 0; idx < SHIM_MAX_IRQ_HANDLERS; idx++) {
+        if (shim_irq_handlers[num][idx] == handler) {
+            shim_irq_handlers[num][idx] = NULL;
+        }
+    }
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    shim_irq_enabled[num] = enabled;
+}
+
+// ---------------------------------------------------------------- pio --
+
+/**
+ * @brief Get the model for a state machine.
+ */
+static shim_sm_t *shim_get_sm(PIO pio, uint sm) {
+    return &shim_sm[pio_get_index(pio)][sm];
+}
+
+/**
+ * @brief Number of words queued behind the one being shifted out.
+ */
+static uint shim_sm_level(const shim_sm_t *s) {
+    if (s->tx_done_ns <= shim_now_ns || s->word_ns == 0) {
+        return 0;
+    }
+    uint64_t in_flight = (s->tx_done_ns - shim_now_ns + s->word_ns - 1) / s->word_ns;
+    return (in_flight > 0) ? (uint) (in_flight - 1) : 0;
+}
+
+/**
+ * @brief TX FIFO depth for a state machine.
+ */
+static uint shim_sm_depth(const shim_sm_t *s) {
+    return (s->config.fifo_join == PIO_FIFO_JOIN_TX) ? 8 : 4;
+}
+
+/**
+ * @brief Queue a word on a state machine without waiting.
+ * 
+ * @return uint64_t The time the word is pulled into the OSR.
+ */
+static uint64_t shim_sm_queue(PIO pio, uint sm, uint32_t word) {
+    shim_sm_t *s = shim_get_sm(pio, sm);
+    uint64_t start = s->tx_done_ns;
+    if (start + SHIM_LATCH_NS <= shim_now_ns || shim_stats.words == 0) {
+        shim_stats.frames++;
+    }
+    if (start < shim_now_ns) {
+        start = shim_now_ns;
+    }
+    s->tx_done_ns = start + s->word_ns;
+    shim_stats.words++;
+    shim_wire_ns += s->word_ns;
+    if (shim_word_hook != NULL) {
+        shim_word_hook(pio, sm, start / 1000u, word);
+    }
+    return start;
+}
+
+pio_sm_config pio_get_default_sm_config(void) {
+    pio_sm_config c;
+    memset(&c, 0, sizeof(c));
+    c.clkdiv_int = 1;
+    c.wrap = SHIM_INSTR_MEM - 1;
+    c.out_count = 0;
+    c.out_shift_right = true;
+    c.pull_threshold = 32;
+    return c;
+}
+
+void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap) {
+    c->wrap_target = wrap_target;
+    c->wrap = wrap;
+}
+
+void sm_config_set_sideset(pio_sm_config *c, uint bit_count, bool optional, bool pindirs) {
+    c->sideset_bit_count = bit_count;
+    c->sideset_optional = optional;
+    c->sideset_pindirs = pindirs;
+}
+
+void sm_config_set_sideset_pins(pio_sm_config *c, uint sideset_base) {
+    c->sideset_base = sideset_base;
+}
+
+void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count) {
+    c->out_base = out_base;
+    c->out_count = out_count;
+}
+
+void sm_config_set_set_pins(pio_sm_config *c, uint set_base, uint set_count) {
+    c->set_base = set_base;
+    c->set_count = set_count;
+}
+
+void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold) {
+    c->out_shift_right = shift_right;
+    c->autopull = autopull;
+    c->pull_threshold = pull_threshold;
+}
+
+void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join) {
+    c->fifo_join = join;
+}
+
+void sm_config_set_clkdiv(pio_sm_config *c, float div) {
+    c->clkdiv_int = (uint32_t) div;
+    c->clkdiv_frac = (uint8_t) ((div - (float) c->clkdiv_int) * 256.0f);
+}
+
+void sm_config_set_clkdiv_int_frac(pio_sm_config *c, uint16_t div_int, uint8_t div_frac) {
+    c->clkdiv_int = div_int;
+    c->clkdiv_frac = div_frac;
+}
+
+void pio_gpio_init(PIO pio, uint pin) {
+}
+
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out) {
+}
+
+/**
+ * @brief Time the loaded program takes to consume one FIFO word.
+ * @details Runs the program in the emulator and measures the interval between
+ * pulls, falling back to SHIM_CYCLES_PER_BIT per shifted bit if the program
+ * cannot be emulated.
+ */
+static uint64_t shim_measure_word_ns(PIO pio, const pio_sm_config *config, uint initial_pc) {
+    pio_emu_t emu;
+    pio_emu_init(&emu, shim_instr[pio_get_index(pio)], config, initial_pc, shim_sys_hz);
+    for (int idx = 0; idx < 4; idx++) {
+        pio_emu_push(&emu, (idx & 1) ? 0xaaaaaaaau : 0x55555555u);
+    }
+    uint64_t first = 0;
+    while (emu.pulls < 4 && emu.fault == false && emu.cycles < 1000000u) {
+        pio_emu_step(&emu);
+        if (emu.pulls == 2 && first == 0) {
+            first = emu.last_pull_sys_cycle;
+        }
+    }
+    if (emu.pulls == 4) {
+        return pio_emu_ns(&emu, emu.last_pull_sys_cycle - first) / 2u;
+    }
+
+    // One bit per word when the OSR drives the pins directly, otherwise one
+    // bit per OSR shift.
+    uint64_t bits = (config->out_count > 0) ? 1 : ((config->pull_threshold == 0) ? 32 : config->pull_threshold);
+    uint64_t div256 = ((uint64_t) config->clkdiv_int << 8) | config->clkdiv_frac;
+    return (bits * SHIM_CYCLES_PER_BIT * div256 * 1000000000ull) / (256ull * shim_sys_hz);
+}
+
+int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config) {
+    shim_sm_t *s = shim_get_sm(pio, sm);
+    s->config = *config;
+    s->initial_pc = initial_pc;
+    s->enabled = false;
+    s->tx_done_ns = shim_now_ns;
+    s->word_ns = shim_measure_word_ns(pio, config, initial_pc);
+    return 0;
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) {
+    shim_get_sm(pio, sm)->enabled = enabled;
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+    shim_sm_t *s = shim_get_sm(pio, sm);
+
+    // Wait for space in the FIFO.
+    uint depth = shim_sm_depth(s);
+    if (shim_sm_level(s) >= depth) {
+        shim_advance_to(s->tx_done_ns - depth * s->word_ns);
+    }
+    shim_sm_queue(pio, sm, data);
+}
+
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm) {
+    return shim_sm_level(shim_get_sm(pio, sm));
+}
+
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm) {
+    return pio_sm_get_tx_fifo_level(pio, sm) == 0;
+}
+
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm) {
+    shim_sm_t *s = shim_get_sm(pio, sm);
+    return shim_sm_level(s) >= shim_sm_depth(s);
+}
+
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx) {
+    return pio_get_index(pio) * 8u + (is_tx ? 0u : 4u) + sm;
+}
+
+uint pio_get_index(PIO pio) {
+    return (uint) (pio - shim_pio_hw);
+}
+
+int pio_add_program_at_offset(PIO pio, const pio_program_t *program, uint offset) {
+    uint index = pio_get_index(pio);
+    uint32_t mask = (1u << program->length) - 1u;
+    if (offset + program->length > SHIM_INSTR_MEM || (shim_instr_used[index] & (mask << offset)) != 0) {
+        return -1;
+    }
+    shim_instr_used[index] |= mask << offset;
+
+    // Relocate the JMP targets, as the SDK does.
+    for (uint idx = 0; idx < program->length; idx++) {
+        uint16_t instr = program->instructions[idx];
+        shim_instr[index][offset + idx] = ((instr & 0xe000u) == 0) ? (uint16_t) (instr + offset) : instr;
+    }
+    return (int) offset;
+}
+
+int pio_add_program(PIO pio, const pio_program_t *program) {
+    for (int offset = SHIM_INSTR_MEM - program->length; offset >= 0; offset--) {
+        if (pio_add_program_at_offset(pio, program, (uint) offset) >= 0) {
+            return offset;
+        }
+    }
+    return -1;
+}
+
+void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset) {
+    uint32_t mask = (1u << program->length) - 1u;
+    shim_instr_used[pio_get_index(pio)] &= ~(mask << loaded_offset);
+}
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+    for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+        shim_sm_t *s = shim_get_sm(pio, sm);
+        if (s->claimed == false) {
+            s->claimed = true;
+            return (int) sm;
+        }
+    }
+    if (required) {
+        fprintf(stderr, "shim: no free state machine\n");
+        abort();
+    }
+    return -1;
+}
+
+void pio_sm_unclaim(PIO pio, uint sm) {
+    shim_get_sm(pio, sm)->claimed = false;
+}
+
+bool pio_claim_free_sm_and_add_program_for_gpio_range(const pio_program_t *program, PIO *pio, uint *sm, uint *offset, uint gpio_base, uint gpio_count, bool set_gpio_base) {
+    for (uint index = 0; index < NUM_PIOS; index++) {
+        PIO candidate = &shim_pio_hw[index];
+        int claimed = pio_claim_unused_sm(candidate, false);
+        if (claimed < 0) {
+            continue;
+        }
+        int loaded = pio_add_program(candidate, program);
+        if (loaded < 0) {
+            pio_sm_unclaim(candidate, (uint) claimed);
+            continue;
+        }
+        *pio = candidate;
+        *sm = (uint) claimed;
+        *offset = (uint) loaded;
+        return true;
+    }
+    return false;
+}
+
+void pio_remove_program_and_unclaim_sm(const pio_program_t *program, PIO pio, uint sm, uint offset) {
+    pio_remove_program(pio, program, offset);
+    pio_sm_unclaim(pio, sm);
+}
+
+// ---------------------------------------------------------------- dma --
+
+/**
+ * @brief Find the state machine whose TX FIFO is at an address.
+ * 
+ * @return true The address is a TX FIFO.
+ */
+static bool shim_find_txf(volatile void *addr, PIO *pio, uint *sm) {
+    for (uint index = 0; index < NUM_PIOS; index++) {
+        for (uint idx = 0; idx < NUM_PIO_STATE_MACHINES; idx++) {
+            if (addr == (volatile void *) &shim_pio_hw[index].txf[idx]) {
+                *pio = &shim_pio_hw[index];
+                *sm = idx;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Advance a DMA address, applying the ring wrap.
+ */
+static uintptr_t shim_dma_step(uintptr_t addr, uint size, bool incr, uint ring_bits) {
+    if (incr == false) {
+        return addr;
+    }
+    if (ring_bits == 0) {
+        return addr + size;
+    }
+    uintptr_t mask = ((uintptr_t) 1 << ring_bits) - 1u;
+    return (addr & ~mask) | ((addr + size) & mask);
+}
+
+/**
+ * @brief Perform a triggered transfer and schedule its completion.
+ */
+static void shim_dma_trigger(uint channel) {
+    shim_dma_t *dma = &shim_dma[channel];
+    const dma_channel_config *c = &dma->config;
+    uint size = 1u << c->size;
+    uintptr_t rd = (uintptr_t) dma->read_addr;
+    uintptr_t wr = (uintptr_t) dma->write_addr;
+    bool ring_wr = c->ring_write && c->ring_size_bits;
+    bool ring_rd = !c->ring_write && c->ring_size_bits;
+    PIO pio;
+    uint sm;
+    bool to_pio = shim_find_txf(dma->write_addr, &pio, &sm);
+
+    shim_stats.dma_transfers++;
+    dma->busy = true;
+    dma->complete_ns = shim_now_ns;
+    for (uint32_t idx = 0; idx < dma->trans_count; idx++) {
+        uint32_t value = 0;
+        memcpy(&value, (const void *) rd, size);
+        if (c->bswap && size == 4) {
+            value = __builtin_bswap32(value);
+        }
+        else if (c->bswap && size == 2) {
+            value = __builtin_bswap16((uint16_t) value);
+        }
+        if (to_pio) {
+
+            // Narrow writes are replicated across the 32 bit bus.
+            value = (size == 1) ? value * 0x01010101u : (size == 2) ? value * 0x00010001u : value;
+            shim_sm_queue(pio, sm, value);
+        }
+        else {
+            memcpy((void *) wr, &value, size);
+            dma->complete_ns += 8;
+        }
+        rd = shim_dma_step(rd, size, c->read_increment, ring_rd ? c->ring_size_bits : 0);
+        wr = shim_dma_step(wr, size, c->write_increment, ring_wr ? c->ring_size_bits : 0);
+    }
+    dma->read_addr = (const volatile void *) rd;
+    dma->write_addr = (volatile void *) wr;
+
+    // A paced transfer finishes once its last word fits in the FIFO.
+    if (to_pio) {
+        shim_sm_t *s = shim_get_sm(pio, sm);
+        uint64_t backlog = (uint64_t) (shim_sm_depth(s) + 1) * s->word_ns;
+        if (s->tx_done_ns > shim_now_ns + backlog) {
+            dma->complete_ns = s->tx_done_ns - backlog;
+        }
+    }
+}
+
+int dma_claim_unused_channel(bool required) {
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ch++) {
+        if (shim_dma[ch].claimed == false) {
+            shim_dma[ch].claimed = true;
+            return (int) ch;
+        }
+    }
+    if (required) {
+        fprintf(stderr, "shim: no free DMA channel\n");
+        abort();
+    }
+    return -1;
+}
+
+void dma_channel_claim(uint channel) {
+    shim_dma[channel].claimed = true;
+}
+
+void dma_channel_unclaim(uint channel) {
+    shim_dma[channel].claimed = false;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    dma_channel_config c;
+    memset(&c, 0, sizeof(c));
+    c.size = DMA_SIZE_32;
+    c.read_increment = true;
+    c.write_increment = false;
+    c.chain_to = channel;
+    c.enable = true;
+    return c;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) {
+    c->size = size;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) {
+    c->read_increment = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) {
+    c->write_increment = incr;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) {
+    c->dreq = dreq;
+}
+
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to) {
+    c->chain_to = chain_to;
+}
+
+void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits) {
+    c->ring_write = write;
+    c->ring_size_bits = size_bits;
+}
+
+void channel_config_set_bswap(dma_channel_config *c, bool bswap) {
+    c->bswap = bswap;
+}
+
+void channel_config_set_irq_quiet(dma_channel_config *c, bool irq_quiet) {
+    c->irq_quiet = irq_quiet;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr, const volatile void *read_addr, uint transfer_count, bool trigger) {
+    shim_dma[channel].config = *config;
+    shim_dma[channel].write_addr = write_addr;
+    shim_dma[channel].read_addr = read_addr;
+    shim_dma[channel].trans_count = transfer_count;
+    if (trigger) {
+        shim_dma_trigger(channel);
+    }
+}
+
+void dma_channel_set_config(uint channel, const dma_channel_config *config, bool trigger) {
+    shim_dma[channel].config = *config;
+    if (trigger) {
+        shim_dma_trigger(channel);
+    }
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger) {
+    shim_dma[channel].read_addr = read_addr;
+    if (trigger) {
+        shim_dma_trigger(channel);
+    }
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger) {
+    shim_dma[channel].write_addr = write_addr;
+    if (trigger) {
+        shim_dma_trigger(channel);
+    }
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger) {
+    shim_dma[channel].trans_count = trans_count;
+    if (trigger) {
+        shim_dma_trigger(channel);
+    }
+}
+
+void dma_channel_start(uint channel) {
+    shim_dma_trigger(channel);
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count) {
+    shim_dma[channel].read_addr = read_addr;
+    shim_dma[channel].trans_count = transfer_count;
+    shim_dma_trigger(channel);
+}
+
+bool dma_channel_is_busy(uint channel) {
+    return shim_dma[channel].busy;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+    while (shim_dma[channel].busy) {
+        shim_advance_to(shim_dma[channel].complete_ns);
+    }
+}
+
+void dma_channel_abort(uint channel) {
+    shim_dma[channel].busy = false;
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+    shim_dma[channel].irq0_enabled = enabled;
+}
+
+bool dma_channel_get_irq0_status(uint channel) {
+    return shim_dma[channel].irq0_status;
+}
+
+void dma_channel_acknowledge_irq0(uint channel) {
+    shim_dma[channel].irq0_status = false;
+}
+
+// ------------------------------------------------- shim control/record --
+
+void shim_set_run_limit_ms(uint64_t ms) {
+    shim_limit_ns = (ms == 0) ? SHIM_FOREVER : ms * 1000000u;
+}
+
+void shim_set_press_interval_ms(uint64_t ms) {
+    shim_press_ns = ms * 1000000u;
+    shim_next_press_ns = (ms == 0) ? SHIM_FOREVER : shim_now_ns + shim_press_ns;
+}
+
+void shim_set_keys(const char *keys, uint64_t interval_ms) {
+    shim_keys = keys;
+    shim_key_ns = interval_ms * 1000000u;
+    shim_next_key_ns = shim_now_ns + shim_key_ns;
+}
+
+void shim_set_sys_hz(uint32_t sys_hz) {
+    shim_sys_hz = sys_hz;
+}
+
+const uint16_t *shim_pio_get_instr(PIO pio) {
+    return shim_instr[pio_get_index(pio)];
+}
+
+bool shim_pio_get_sm(PIO pio, uint sm, pio_sm_config *config, uint *initial_pc) {
+    shim_sm_t *s = shim_get_sm(pio, sm);
+    *config = s->config;
+    *initial_pc = s->initial_pc;
+    return s->claimed;
+}
+
+void shim_set_word_hook(shim_word_hook_t hook) {
+    shim_word_hook = hook;
+}
+
+const shim_stats_t *shim_get_stats(void) {
+    shim_stats.now_us = shim_now_ns / 1000u;
+    shim_stats.wire_us = shim_wire_ns / 1000u;
+    return &shim_stats;
+}
+
+void shim_report(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double wall_s = (double) (now.tv_sec - shim_wall_start.tv_sec) + (double) (now.tv_nsec - shim_wall_start.tv_nsec) / 1e9;
+    double virt_s = (double) shim_now_ns / 1e9;
+
+    fprintf(stderr, "shim: virtual time    %.3f s\n", virt_s);
+    fprintf(stderr, "shim: wall time       %.3f s (%.0fx real time)\n", wall_s, (wall_s > 0) ? virt_s / wall_s : 0.0);
+    fprintf(stderr, "shim: words sent      %llu\n", (unsigned long long) shim_stats.words);
+    fprintf(stderr, "shim: frames sent     %llu (%.1f fps)\n", (unsigned long long) shim_stats.frames, (virt_s > 0) ? (double) shim_stats.frames / virt_s : 0.0);
+    fprintf(stderr, "shim: wire busy       %.1f %%\n", (virt_s > 0) ? (double) shim_wire_ns / (virt_s * 1e7) : 0.0);
+    fprintf(stderr, "shim: dma transfers   %llu\n", (unsigned long long) shim_stats.dma_transfers);
+    fprintf(stderr, "shim: button presses  %llu\n", (unsigned long long) shim_stats.presses);
+}
+
+/**
+ * @brief Start the wall clock before main() runs.
+ */
+__attribute__((constructor)) static void shim_start(void) {
+    clock_gettime(CLOCK_MONOTONIC, &shim_wall_start);
+}
+
+/* End. */
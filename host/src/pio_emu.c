@@ -0,0 +1,305 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Cycle accurate emulator for a single PIO state machine.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pio_emu.h"
+
+// Instruction classes, bits 15:13.
+#define OP_JMP      (0u)
+#define OP_WAIT     (1u)
+#define OP_IN       (2u)
+#define OP_OUT      (3u)
+#define OP_PUSHPULL (4u)
+#define OP_MOV      (5u)
+#define OP_IRQ      (6u)
+#define OP_SET      (7u)
+
+/**
+ * @brief Write a group of consecutive pins.
+ */
+static void pio_emu_write_pins(pio_emu_t *emu, uint base, uint count, uint32_t value) {
+    for (uint idx = 0; idx < count; idx++) {
+        uint pin = (base + idx) & 31u;
+        if (value & (1u << idx)) {
+            emu->pins |= 1u << pin;
+        }
+        else {
+            emu->pins &= ~(1u << pin);
+        }
+    }
+}
+
+/**
+ * @brief Refill the OSR from the FIFO.
+ * 
+ * @return true The OSR was refilled.
+ * @return false The FIFO is empty.
+ */
+static bool pio_emu_pull(pio_emu_t *emu) {
+    if (emu->fifo_count == 0) {
+        return false;
+    }
+    emu->osr = emu->fifo[emu->fifo_head];
+    emu->fifo_head = (emu->fifo_head + 1) % PIO_EMU_FIFO_SIZE;
+    emu->fifo_count--;
+    emu->osr_count = 0;
+    emu->pulls++;
+    emu->last_pull_sys_cycle = emu->sys_cycles;
+    return true;
+}
+
+/**
+ * @brief Shift bits out of the OSR.
+ */
+static uint32_t pio_emu_shift_out(pio_emu_t *emu, uint count) {
+    uint32_t data;
+    if (count == 32) {
+        data = emu->osr;
+        emu->osr = 0;
+    }
+    else if (emu->config.out_shift_right) {
+        data = emu->osr & ((1u << count) - 1u);
+        emu->osr >>= count;
+    }
+    else {
+        data = emu->osr >> (32 - count);
+        emu->osr <<= count;
+    }
+    emu->osr_count = (emu->osr_count + count > 32) ? 32 : emu->osr_count + count;
+    return data;
+}
+
+/**
+ * @brief Read a MOV source.
+ */
+static uint32_t pio_emu_source(pio_emu_t *emu, uint src) {
+    switch (src) {
+        case 0: return emu->pins;
+        case 1: return emu->x;
+        case 2: return emu->y;
+        case 3: return 0;
+        case 5: return (emu->fifo_count == 0) ? 0xffffffffu : 0;
+        case 7: return emu->osr;
+        default:
+            emu->fault = true;
+            return 0;
+    }
+}
+
+/**
+ * @brief Execute an instruction.
+ * 
+ * @return true The instruction completed.
+ * @return false The instruction stalled.
+ */
+static bool pio_emu_execute(pio_emu_t *emu, uint16_t instr, uint *next_pc) {
+    uint op = instr >> 13;
+    uint arg1 = (instr >> 5) & 7u;
+    uint arg2 = instr & 31u;
+
+    switch (op) {
+        case OP_JMP: {
+            bool take;
+            switch (arg1) {
+                default:
+                case 0: take = true; break;
+                case 1: take = (emu->x == 0); break;
+                case 2: take = (emu->x-- != 0); break;
+                case 3: take = (emu->y == 0); break;
+                case 4: take = (emu->y-- != 0); break;
+                case 5: take = (emu->x != emu->y); break;
+                case 6: take = false; break;
+                case 7: {
+                    uint threshold = emu->config.pull_threshold ? emu->config.pull_threshold : 32;
+                    take = (emu->osr_count < threshold);
+                    break;
+                }
+            }
+            if (take) {
+                *next_pc = arg2;
+            }
+            return true;
+        }
+        case OP_OUT: {
+            uint threshold = emu->config.pull_threshold ? emu->config.pull_threshold : 32;
+            if (emu->config.autopull && emu->osr_count >= threshold) {
+                if (pio_emu_pull(emu) == false) {
+                    return false;
+                }
+            }
+            uint32_t data = pio_emu_shift_out(emu, arg2 ? arg2 : 32);
+            switch (arg1) {
+                case 0: pio_emu_write_pins(emu, emu->config.out_base, emu->config.out_count, data); break;
+                case 1: emu->x = data; break;
+                case 2: emu->y = data; break;
+                case 3: break;
+                case 5: *next_pc = data & 31u; break;
+                default: emu->fault = true; break;
+            }
+            return true;
+        }
+        case OP_PUSHPULL: {
+            if ((instr & 0x80u) == 0) {
+                return true;
+            }
+            uint threshold = emu->config.pull_threshold ? emu->config.pull_threshold : 32;
+            bool if_empty = (instr & 0x40u) != 0;
+            bool block = (instr & 0x20u) != 0;
+            if (if_empty && emu->osr_count < threshold) {
+                return true;
+            }
+            if (pio_emu_pull(emu) == false) {
+                if (block) {
+                    return false;
+                }
+                emu->osr = emu->x;
+                emu->osr_count = 0;
+            }
+            return true;
+        }
+        case OP_MOV: {
+            uint32_t data = pio_emu_source(emu, instr & 7u);
+            switch ((instr >> 3) & 3u) {
+                case 1: data = ~data; break;
+                case 2: {
+                    uint32_t rev = 0;
+                    for (int bit = 0; bit < 32; bit++) {
+                        rev |= ((data >> bit) & 1u) << (31 - bit);
+                    }
+                    data = rev;
+                    break;
+                }
+                default: break;
+            }
+            switch (arg1) {
+                case 0: pio_emu_write_pins(emu, emu->config.out_base, emu->config.out_count, data); break;
+                case 1: emu->x = data; break;
+                case 2: emu->y = data; break;
+                case 5: *next_pc = data & 31u; break;
+                case 7: emu->osr = data; emu->osr_count = 0; break;
+                default: emu->fault = true; break;
+            }
+            return true;
+        }
+        case OP_IRQ:
+            return true;
+        case OP_SET:
+            switch (arg1) {
+                case 0: pio_emu_write_pins(emu, emu->config.set_base, emu->config.set_count, arg2); break;
+                case 1: emu->x = arg2; break;
+                case 2: emu->y = arg2; break;
+                case 4: break;
+                default: emu->fault = true; break;
+            }
+            return true;
+        default:
+            emu->fault = true;
+            return true;
+    }
+}
+
+void pio_emu_init(pio_emu_t *emu, const uint16_t *instr_mem, const pio_sm_config *config, uint initial_pc, uint32_t sys_hz) {
+    memset(emu, 0, sizeof(*emu));
+    memcpy(emu->instr, instr_mem, sizeof(emu->instr));
+    emu->config = *config;
+    emu->sys_hz = sys_hz;
+    emu->pc = initial_pc;
+    emu->osr_count = 32;
+}
+
+void pio_emu_set_edge_callback(pio_emu_t *emu, pio_emu_edge_t edge, void *context) {
+    emu->edge = edge;
+    emu->context = context;
+}
+
+bool pio_emu_push(pio_emu_t *emu, uint32_t word) {
+    if (emu->fifo_count == PIO_EMU_FIFO_SIZE) {
+        return false;
+    }
+    emu->fifo[(emu->fifo_head + emu->fifo_count) % PIO_EMU_FIFO_SIZE] = word;
+    emu->fifo_count++;
+    return true;
+}
+
+void pio_emu_step(pio_emu_t *emu) {
+    uint32_t before = emu->pins;
+
+    if (emu->delay > 0) {
+        emu->delay--;
+        emu->stalled = false;
+    }
+    else {
+        uint16_t instr = emu->instr[emu->pc];
+        uint side_bits = emu->config.sideset_bit_count;
+        uint delay_bits = 5 - side_bits;
+        uint field = (instr >> 8) & 31u;
+        uint delay = field & ((1u << delay_bits) - 1u);
+        uint side = field >> delay_bits;
+
+        // Side-set takes effect even if the instruction stalls.
+        if (side_bits > 0) {
+            uint side_count = side_bits;
+            bool enabled = true;
+            if (emu->config.sideset_optional) {
+                side_count--;
+                enabled = (side >> side_count) & 1u;
+                side &= (1u << side_count) - 1u;
+            }
+            if (enabled && emu->config.sideset_pindirs == false) {
+                pio_emu_write_pins(emu, emu->config.sideset_base, side_count, side);
+            }
+        }
+
+        uint next_pc = (emu->pc == emu->config.wrap) ? emu->config.wrap_target : (emu->pc + 1) & 31u;
+        emu->stalled = (pio_emu_execute(emu, instr, &next_pc) == false);
+        if (emu->stalled == false) {
+            emu->pc = next_pc;
+            emu->delay = delay;
+        }
+    }
+
+    // Report pin changes at the start of this cycle.
+    uint32_t changed = emu->pins ^ before;
+    if (changed && emu->edge != NULL) {
+        uint64_t time_ns = pio_emu_ns(emu, emu->sys_cycles);
+        for (uint pin = 0; pin < 32; pin++) {
+            if (changed & (1u << pin)) {
+                emu->edge(emu->context, pin, (emu->pins >> pin) & 1u, time_ns);
+            }
+        }
+    }
+
+    // The fractional divider stretches some cycles by one system clock.
+    uint64_t period = emu->config.clkdiv_int ? emu->config.clkdiv_int : 65536u;
+    emu->frac_acc += emu->config.clkdiv_frac;
+    if (emu->frac_acc >= 256u) {
+        emu->frac_acc -= 256u;
+        period++;
+    }
+    emu->sys_cycles += period;
+    emu->cycles++;
+}
+
+bool pio_emu_run(pio_emu_t *emu, uint64_t max_cycles) {
+    for (uint64_t idx = 0; idx < max_cycles && emu->fault == false; idx++) {
+        pio_emu_step(emu);
+        if (emu->stalled && emu->fifo_count == 0) {
+            return true;
+        }
+    }
+    if (emu->fault) {
+        fprintf(stderr, "pio_emu: unsupported instruction 0x%04x at %u\n", emu->instr[emu->pc], emu->pc);
+    }
+    return false;
+}
+
+uint64_t pio_emu_ns(const pio_emu_t *emu, uint64_t sys_cycles) {
+    return (uint64_t) (((unsigned __int128) sys_cycles * 1000000000u) / emu->sys_hz);
+}
+
+/* End. */
@@ -0,0 +1,138 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Benchmarks the bit-plane transpose kernels for 8, 16 and 32 strings.
+ *
+ * Each kernel is checked against the reference, then timed on the host.
+ * The Cortex-M0+ figure is an estimate from a cost model of each kernel's
+ * inner loop: ALU operations 1 cycle, loads, stores and literal masks 2
+ * cycles, plus register spills where the working set exceeds r0-r7.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "led_transpose.h"
+
+#define M0_HZ (125000000.0)
+
+/**
+ * @brief Kernel under test.
+ */
+typedef struct bench_kernel {
+    const char *name;                   // Kernel name.
+    unsigned lanes;                     // Strings transposed.
+    void (*fixed)(uint32_t *, const uint32_t *, size_t, size_t);
+    void (*any)(uint32_t *, const uint32_t *, unsigned, size_t, size_t);
+    unsigned m0_cycles;                 // Estimated M0+ cycles per pixel position.
+} bench_kernel_t;
+
+// Cycle estimates per pixel position (one pixel on every lane):
+//  reference  24 bits x lanes x (load, shift, and, shift, orr) + 24 stores
+//  8 lanes    8 loads, 2 4x4 byte and 3 8x8 bit transposes, 24 extracts and stores, spills
+//  16 lanes   2 x 8 lane gathers and transposes, 24 half word zips and stores
+//  32 lanes   32 loads and stores, 80 in-memory delta swaps, 24 word copies
+static const bench_kernel_t kernels[] = {
+    {"reference", 8, NULL, led_transpose_reference, 24 * 8 * 6 + 48},
+    {"any", 8, NULL, led_transpose_any, 420},
+    {"specialised", 8, led_transpose_8, NULL, 328},
+    {"reference", 16, NULL, led_transpose_reference, 24 * 16 * 6 + 48},
+    {"any", 16, NULL, led_transpose_any, 840},
+    {"specialised", 16, led_transpose_16, NULL, 656},
+    {"reference", 32, NULL, led_transpose_reference, 24 * 32 * 6 + 48},
+    {"any", 32, NULL, led_transpose_any, 1680},
+    {"specialised", 32, led_transpose_32, NULL, 1344},
+};
+
+/**
+ * @brief Run a kernel once over the first count pixels of each string.
+ */
+static void run(const bench_kernel_t *k, uint32_t *planes, const uint32_t *strips, size_t strip_size, size_t count) {
+    if (k->fixed != NULL) {
+        k->fixed(planes, strips, strip_size, count);
+    }
+    else {
+        k->any(planes, strips, k->lanes, strip_size, count);
+    }
+}
+
+/**
+ * @brief Monotonic time in nanoseconds.
+ */
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+/**
+ * @brief Program entry point.
+ */
+int main(int argc, char **argv) {
+    size_t strip_size = (argc > 1) ? strtoul(argv[1], NULL, 0) : 100;
+    if (strip_size == 0) {
+        fprintf(stderr, "usage: %s [pixels per string]\n", argv[0]);
+        return 2;
+    }
+
+    uint32_t *strips = malloc(32 * strip_size * sizeof(uint32_t));
+    uint32_t *planes = malloc(LED_TRANSPOSE_BITS * strip_size * sizeof(uint32_t));
+    uint32_t *expect = malloc(LED_TRANSPOSE_BITS * strip_size * sizeof(uint32_t));
+    uint32_t seed = 0x2545f491u;
+    for (size_t idx = 0; idx < 32 * strip_size; idx++) {
+        seed = seed * 1664525u + 1013904223u;
+        strips[idx] = seed >> 8;
+    }
+
+    printf("%zu pixels per string\n", strip_size);
+    printf("The M0+ columns are estimates from a cost model, not measurements.\n");
+    printf("%-12s %5s %12s %14s %16s\n", "kernel", "lanes", "host ns/px", "model M0+ c/px", "model M0+ us/fr");
+    int status = 0;
+    for (size_t n = 0; n < sizeof(kernels) / sizeof(kernels[0]); n++) {
+        const bench_kernel_t *k = &kernels[n];
+
+        // Check the whole strings, then a prefix of them.
+        led_transpose_reference(expect, strips, k->lanes, strip_size, strip_size);
+        run(k, planes, strips, strip_size, strip_size);
+        bool match = memcmp(planes, expect, LED_TRANSPOSE_BITS * strip_size * sizeof(uint32_t)) == 0;
+        size_t prefix = (strip_size + 1) / 2;
+        memset(planes, 0, LED_TRANSPOSE_BITS * strip_size * sizeof(uint32_t));
+        run(k, planes, strips, strip_size, prefix);
+        match = match && memcmp(planes, expect, LED_TRANSPOSE_BITS * prefix * sizeof(uint32_t)) == 0;
+        if (match == false) {
+            printf("%-12s %5u  MISMATCH\n", k->name, k->lanes);
+            status = 1;
+            continue;
+        }
+
+        // Repeat until the run is long enough to time.
+        size_t reps = 1;
+        double elapsed;
+        for (;;) {
+            double start = now_ns();
+            for (size_t rep = 0; rep < reps; rep++) {
+                run(k, planes, strips, strip_size, strip_size);
+                __asm__ volatile("" : : "r"(planes) : "memory");
+            }
+            elapsed = now_ns() - start;
+            if (elapsed > 2e8) {
+                break;
+            }
+            reps *= 2;
+        }
+        double pixels = (double) reps * (double) strip_size * k->lanes;
+        double m0_px = (double) k->m0_cycles / k->lanes;
+        printf("%-12s %5u %12.3f %14.1f %16.0f\n", k->name, k->lanes, elapsed / pixels, m0_px,
+            m0_px * (double) strip_size * k->lanes / M0_HZ * 1e6);
+    }
+
+    free(strips);
+    free(planes);
+    free(expect);
+    return status;
+}
+
+/* End. */
@@ -0,0 +1,316 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Runs the ws2812 and ws2812_parallel programs in the PIO emulator and checks
+ * the pin waveform against the WS2812B timing windows.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico_shim.h"
+#include "pio_emu.h"
+#include "led_timing.h"
+#include "ws2812.pio.h"
+
+#define DATA_PIN        (28)
+#define MAX_PIXELS      (4096)
+
+/**
+ * @brief An allowed range for a pulse width.
+ */
+typedef struct timing_window {
+    const char *name;                   // Datasheet name.
+    uint32_t min_ns;                    // Shortest allowed.
+    uint32_t max_ns;                    // Longest allowed.
+} timing_window_t;
+
+/**
+ * @brief Measured range for a pulse width.
+ */
+typedef struct timing_range {
+    uint64_t min_ns;                    // Shortest seen.
+    uint64_t max_ns;                    // Longest seen.
+    uint64_t total_ns;                  // Sum of all seen.
+    uint64_t count;                     // Number seen.
+} timing_range_t;
+
+/**
+ * @brief Captured edge.
+ */
+typedef struct edge {
+    uint64_t time_ns;                   // When the pin changed.
+    bool level;                         // New level.
+} edge_t;
+
+// WS2812B datasheet: T0H 0.4us, T1H 0.8us (+/-150ns). The low time between
+// bits (TLL) only needs to be shorter than the reset time.
+static const timing_window_t ws2812b_t0h = {"T0H", 250, 550};
+static const timing_window_t ws2812b_t1h = {"T1H", 650, 950};
+static const timing_window_t ws2812b_tll = {"TLL", 300, 5000};
+
+// Operating data.
+static edge_t                   *edges = NULL;                  // Edges on the observed pin.
+static size_t                   edge_count = 0;                 // Number of captured edges.
+static uint                     edge_pin = DATA_PIN;            // Pin being observed.
+
+/**
+ * @brief Record an edge on the observed pin.
+ */
+static void on_edge(void *context, uint pin, bool level, uint64_t time_ns) {
+    if (pin == edge_pin) {
+        edges[edge_count].time_ns = time_ns;
+        edges[edge_count].level = level;
+        edge_count++;
+    }
+}
+
+/**
+ * @brief Add a sample to a range.
+ */
+static void range_add(timing_range_t *range, uint64_t ns) {
+    if (range->count == 0 || ns < range->min_ns) {
+        range->min_ns = ns;
+    }
+    if (range->count == 0 || ns > range->max_ns) {
+        range->max_ns = ns;
+    }
+    range->total_ns += ns;
+    range->count++;
+}
+
+/**
+ * @brief Print a range and check it against a window.
+ * 
+ * @return true The range is inside the window.
+ */
+static bool range_check(const timing_window_t *window, const timing_range_t *range) {
+    bool ok = range->count > 0 && range->min_ns >= window->min_ns && range->max_ns <= window->max_ns;
+    printf("  %s  %5llu .. %5llu ns  (window %u .. %u)  %s\n", window->name,
+        (unsigned long long) range->min_ns, (unsigned long long) range->max_ns,
+        window->min_ns, window->max_ns, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+/**
+ * @brief Print the command line options.
+ */
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [--sys-hz N] [--freq N] [--t T1,T2,T3] [--profile NAME] [--parallel] [--lanes N] [--pixels N]\n", name);
+    fprintf(stderr, "  --sys-hz N       system clock (default 125000000)\n");
+    fprintf(stderr, "  --freq N         bit rate passed to the init function (default 800000)\n");
+    fprintf(stderr, "  --t T1,T2,T3     override the program delays (default from ws2812.pio)\n");
+    fprintf(stderr, "  --profile NAME   fit a timing profile with an integer divider and check against it\n");
+    fprintf(stderr, "  --parallel       emulate ws2812_parallel and observe lane 0\n");
+    fprintf(stderr, "  --lanes N        parallel pin count (default 8)\n");
+    fprintf(stderr, "  --pixels N       pixels to send (default 64)\n");
+}
+
+/**
+ * @brief Program entry point.
+ */
+int main(int argc, char **argv) {
+    uint32_t sys_hz = 125000000u;
+    float freq = 800000.0f;
+    bool parallel = false;
+    uint lanes = 8;
+    size_t pixels = 64;
+    uint t1 = ws2812_T1, t2 = ws2812_T2, t3 = ws2812_T3;
+    bool patched = false;
+    const led_timing_profile_t *profile = NULL;
+
+    for (int idx = 1; idx < argc; idx++) {
+        if (strcmp(argv[idx], "--sys-hz") == 0 && idx + 1 < argc) {
+            sys_hz = (uint32_t) strtoul(argv[++idx], NULL, 0);
+        }
+        else if (strcmp(argv[idx], "--freq") == 0 && idx + 1 < argc) {
+            freq = strtof(argv[++idx], NULL);
+        }
+        else if (strcmp(argv[idx], "--t") == 0 && idx + 1 < argc) {
+            if (sscanf(argv[++idx], "%u,%u,%u", &t1, &t2, &t3) != 3 || t1 < 1 || t2 < 1 || t3 < 2) {
+                usage(argv[0]);
+                return 2;
+            }
+            patched = true;
+        }
+        else if (strcmp(argv[idx], "--profile") == 0 && idx + 1 < argc) {
+            profile = led_timing_find(argv[++idx]);
+            if (profile == NULL) {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        else if (strcmp(argv[idx], "--parallel") == 0) {
+            parallel = true;
+        }
+        else if (strcmp(argv[idx], "--lanes") == 0 && idx + 1 < argc) {
+            lanes = (uint) strtoul(argv[++idx], NULL, 0);
+        }
+        else if (strcmp(argv[idx], "--pixels") == 0 && idx + 1 < argc) {
+            pixels = strtoul(argv[++idx], NULL, 0);
+        }
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (pixels == 0 || pixels > MAX_PIXELS || lanes == 0 || lanes > 32) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (parallel && patched == false) {
+        t1 = ws2812_parallel_T1;
+        t2 = ws2812_parallel_T2;
+        t3 = ws2812_parallel_T3;
+    }
+
+    // A profile chooses the delays and an integer divider, and sets the
+    // windows the pulses are checked against.
+    timing_window_t t0h_window = ws2812b_t0h;
+    timing_window_t t1h_window = ws2812b_t1h;
+    led_timing_t timing = { (uint8_t) t1, (uint8_t) t2, (uint8_t) t3, 0 };
+    if (profile != NULL) {
+        if (led_timing_solve(profile, sys_hz, parallel, &timing) == false) {
+            fprintf(stderr, "%s cannot be met at %u Hz\n", profile->name, sys_hz);
+            return 1;
+        }
+        t1 = timing.t1;
+        t2 = timing.t2;
+        t3 = timing.t3;
+        patched = true;
+        t0h_window.min_ns = profile->t0h_ns - 150u;
+        t0h_window.max_ns = profile->t0h_ns + 150u;
+        t1h_window.min_ns = profile->t1h_ns - 150u;
+        t1h_window.max_ns = profile->t1h_ns + 150u;
+        printf("%s: T0H %u ns, T1H %u ns, bit %u ns expected\n", profile->name,
+            timing.t0h_ns, timing.t1h_ns, timing.bit_ns);
+    }
+
+    // Load the program and let its init function build the configuration.
+    shim_set_sys_hz(sys_hz);
+    const pio_program_t *base = parallel ? &ws2812_parallel_program : &ws2812_program;
+    uint16_t instr[PIO_EMU_INSTR_MEM];
+    pio_program_t program = *base;
+    if (patched) {
+        led_timing_patch(&program, instr, base, parallel, &timing);
+    }
+
+    PIO pio;
+    uint sm;
+    uint offset;
+    if (pio_claim_free_sm_and_add_program_for_gpio_range(&program, &pio, &sm, &offset, DATA_PIN, lanes, true) == false) {
+        fprintf(stderr, "failed to load the program\n");
+        return 1;
+    }
+    if (parallel && profile != NULL) {
+        ws2812_parallel_program_init_clkdiv(pio, sm, offset, DATA_PIN, lanes, timing.div, 0);
+    }
+    else if (parallel) {
+        ws2812_parallel_program_init(pio, sm, offset, DATA_PIN, lanes, freq);
+    }
+    else if (profile != NULL) {
+        ws2812_program_init_clkdiv(pio, sm, offset, DATA_PIN, timing.div, 0, false);
+    }
+    else {
+        ws2812_program_init(pio, sm, offset, DATA_PIN, freq, false);
+    }
+
+    pio_sm_config config;
+    uint initial_pc;
+    shim_pio_get_sm(pio, sm, &config, &initial_pc);
+    if (patched && profile == NULL) {
+        // The init function divides by the assembled T1+T2+T3.
+        sm_config_set_clkdiv(&config, (float) sys_hz / (freq * (float) (t1 + t2 + t3)));
+    }
+
+    // Build the bit stream: fixed patterns then pseudo random pixels.
+    static const uint32_t fixed[] = {0x000000u, 0xffffffu, 0xaa55aau, 0x55aa55u, 0xf0f0f0u, 0x0f0f0fu};
+    uint32_t *pixel = calloc(pixels, sizeof(uint32_t));
+    uint32_t seed = 0x12345678u;
+    for (size_t idx = 0; idx < pixels; idx++) {
+        seed = seed * 1664525u + 1013904223u;
+        pixel[idx] = (idx < sizeof(fixed) / sizeof(fixed[0])) ? fixed[idx] : (seed >> 8);
+    }
+    size_t bits = pixels * 24;
+    size_t words = parallel ? bits : pixels;
+    edges = calloc(bits * 2 + 4, sizeof(edge_t));
+
+    // Run the emulator, keeping the FIFO topped up.
+    pio_emu_t emu;
+    pio_emu_init(&emu, shim_pio_get_instr(pio), &config, initial_pc, sys_hz);
+    pio_emu_set_edge_callback(&emu, on_edge, NULL);
+    size_t next_word = 0;
+    uint64_t max_cycles = (uint64_t) bits * 64u * 1024u;
+    while (emu.cycles < max_cycles && emu.fault == false) {
+        while (next_word < words) {
+            uint32_t word;
+            if (parallel) {
+                size_t px = next_word / 24;
+                uint bit = 23 - (uint) (next_word % 24);
+                seed = seed * 1664525u + 1013904223u;
+                word = (seed & ~1u) | ((pixel[px] >> bit) & 1u);
+            }
+            else {
+                word = pixel[next_word] << 8u;
+            }
+            if (pio_emu_push(&emu, word) == false) {
+                break;
+            }
+            next_word++;
+        }
+        pio_emu_step(&emu);
+        if (next_word == words && emu.stalled && emu.fifo_count == 0) {
+            break;
+        }
+    }
+    if (emu.fault) {
+        fprintf(stderr, "emulation failed\n");
+        return 1;
+    }
+
+    // Pair each rising edge with its falling edge and the next rise.
+    timing_range_t t0h = {0}, t1h = {0}, tll = {0}, period = {0};
+    size_t bit = 0;
+    for (size_t idx = 0; idx + 1 < edge_count; idx++) {
+        if (edges[idx].level == false || edges[idx + 1].level) {
+            continue;
+        }
+        uint64_t high = edges[idx + 1].time_ns - edges[idx].time_ns;
+        bool one = (pixel[bit / 24] >> (23 - (bit % 24))) & 1u;
+        range_add(one ? &t1h : &t0h, high);
+        if (idx + 2 < edge_count) {
+            range_add(&tll, edges[idx + 2].time_ns - edges[idx + 1].time_ns);
+            range_add(&period, edges[idx + 2].time_ns - edges[idx].time_ns);
+        }
+        bit++;
+    }
+
+    double div = config.clkdiv_int + config.clkdiv_frac / 256.0;
+    printf("%s: sys %u Hz, T1/T2/T3 %u/%u/%u, divider %u + %u/256 (%.4f)%s\n",
+        parallel ? "ws2812_parallel" : "ws2812", sys_hz, t1, t2, t3,
+        config.clkdiv_int, config.clkdiv_frac, div, config.clkdiv_frac ? " fractional" : " integer");
+    printf("  sent %zu bits, saw %zu pulses\n", bits, bit);
+
+    bool ok = (bit == bits);
+    ok = range_check(&t0h_window, &t0h) && ok;
+    ok = range_check(&t1h_window, &t1h) && ok;
+    ok = range_check(&ws2812b_tll, &tll) && ok;
+
+    if (period.count > 0) {
+        double avg = (double) period.total_ns / (double) period.count;
+        double bit_rate = 1e9 / avg;
+        printf("  bit period %llu .. %llu ns (avg %.1f, jitter %llu ns)\n",
+            (unsigned long long) period.min_ns, (unsigned long long) period.max_ns, avg,
+            (unsigned long long) (period.max_ns - period.min_ns));
+        printf("  throughput %.0f bit/s, %.0f pixel/s%s\n", bit_rate,
+            bit_rate / 24.0 * (parallel ? lanes : 1), parallel ? " (all lanes)" : "");
+    }
+    printf("%s\n", ok ? "PASS" : "FAIL");
+
+    free(pixel);
+    free(edges);
+    return ok ? 0 : 1;
+}
+
+/* End. */
@@ -0,0 +1,45 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Animation clock and fixed point easing for the LED patterns.
+ */
+
+#include "pico/stdlib.h"
+#include "led_anim.h"
+
+// Operating data.
+static absolute_time_t          led_anim_base;                  // Time 0.
+static uint32_t                 led_anim_lead_us = 0;           // Added to each reading.
+
+void led_anim_start(uint32_t lead_us) {
+    led_anim_base = get_absolute_time();
+    led_anim_lead_us = lead_us;
+}
+
+uint32_t led_anim_ms(void) {
+    int64_t us = absolute_time_diff_us(led_anim_base, get_absolute_time()) + led_anim_lead_us;
+    return (uint32_t) (us / 1000);
+}
+
+uint32_t led_anim_phase(uint32_t t_ms, uint32_t period_ms) {
+    if (period_ms == 0) {
+        return 0;
+    }
+    return (uint32_t) (((uint64_t) (t_ms % period_ms) << 16) / period_ms);
+}
+
+uint32_t led_anim_triangle(uint32_t phase) {
+    phase &= LED_ANIM_ONE - 1u;
+    return (phase < LED_ANIM_ONE / 2u) ? phase * 2u : (LED_ANIM_ONE - phase) * 2u;
+}
+
+uint32_t led_anim_ease(uint32_t x) {
+    if (x >= LED_ANIM_ONE) {
+        return LED_ANIM_ONE;
+    }
+    uint64_t x2 = ((uint64_t) x * x) >> 16;
+    uint64_t x3 = (x2 * x) >> 16;
+    return (uint32_t) (3u * x2 - 2u * x3);
+}
+
+/* End. */
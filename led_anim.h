@@ -0,0 +1,81 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Animation clock and fixed point easing for the LED patterns.
+ *
+ * Patterns work out what to show from the time since they started rather
+ * than counting the frames they have rendered, so a frame that is late, or
+ * skipped, shows the state for the moment it reaches the LEDs and the speed
+ * of the animation does not depend on the frame rate. Phases and the
+ * shapes built from them are Q16 fractions, LED_ANIM_ONE being a whole
+ * cycle or full scale, so no floating point is needed on the Cortex-M0+.
+ */
+
+#ifndef LED_ANIM_H
+#define LED_ANIM_H
+
+#include <stdint.h>
+
+/**
+ * @brief A whole cycle, or full scale, in Q16.
+ */
+#define LED_ANIM_ONE (0x10000u)
+
+/**
+ * @brief Start the clock at 0.
+ * @details The clock reads ahead by the lead time, so a frame rendered that
+ * long before it is shown is drawn for the time it is shown.
+ * 
+ * @param lead_us Time from reading the clock to the frame reaching the LEDs
+ * (in us).
+ */
+void led_anim_start(uint32_t lead_us);
+
+/**
+ * @brief Read the clock.
+ * 
+ * @return uint32_t Time since led_anim_start() plus the lead (in ms).
+ */
+uint32_t led_anim_ms(void);
+
+/**
+ * @brief Get the position in a repeating cycle.
+ * 
+ * @param t_ms Time (in ms).
+ * @param period_ms Length of the cycle (in ms), 1 or more.
+ * @return uint32_t Phase, 0 to LED_ANIM_ONE - 1.
+ */
+uint32_t led_anim_phase(uint32_t t_ms, uint32_t period_ms);
+
+/**
+ * @brief Rise from 0 to full scale over the first half of a cycle and fall
+ * back over the second.
+ * 
+ * @param phase Phase, 0 to LED_ANIM_ONE - 1.
+ * @return uint32_t Level, 0 to LED_ANIM_ONE.
+ */
+uint32_t led_anim_triangle(uint32_t phase);
+
+/**
+ * @brief Ease in and out (smoothstep, 3x^2 - 2x^3).
+ * @details Slow near 0 and full scale and quickest half way, so a triangle
+ * eased this way lingers at each end like a sine wave.
+ * 
+ * @param x Level, 0 to LED_ANIM_ONE.
+ * @return uint32_t Eased level, 0 to LED_ANIM_ONE.
+ */
+uint32_t led_anim_ease(uint32_t x);
+
+/**
+ * @brief Scale a level to a channel value.
+ * 
+ * @param x Level, 0 to LED_ANIM_ONE.
+ * @return uint8_t Channel value, 0 to 255.
+ */
+static inline uint8_t led_anim_u8(uint32_t x) {
+    return (uint8_t) ((x * 255u + LED_ANIM_ONE / 2u) >> 16);
+}
+
+#endif // LED_ANIM_H
+
+/* End. */
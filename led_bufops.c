@@ -0,0 +1,171 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Frame buffer fills and copies on a spare DMA channel.
+ */
+
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "led_bufops.h"
+#include "led_stats.h"
+
+/**
+ * @brief A queued operation.
+ */
+typedef struct led_bufops_op_s {
+    uint32_t *dst;                      // Destination words.
+    const uint32_t *src;                // Source words, NULL to fill with value.
+    uint32_t value;                     // Fill value, read by the DMA in place.
+    size_t count;                       // The number of words.
+} led_bufops_op_t;
+
+// Operating data.
+static int                      led_bufops_chan = -1;           // Claimed DMA channel.
+static dma_channel_config       led_bufops_copy_config;         // Incrementing reads.
+static dma_channel_config       led_bufops_fill_config;         // Fixed read of the fill value.
+static led_bufops_op_t          led_bufops_queue[LED_BUFOPS_QUEUE + 1]; // Running operation first.
+static volatile size_t          led_bufops_head = 0;            // Running (or next) operation.
+static volatile size_t          led_bufops_queued = 0;          // Operations running or waiting.
+
+/**
+ * @brief Start the operation at the head of the queue on the DMA.
+ */
+static void led_bufops_start(void) {
+    led_bufops_op_t *op = &led_bufops_queue[led_bufops_head];
+    if (op->src == NULL) {
+        dma_channel_configure(led_bufops_chan, &led_bufops_fill_config, op->dst, &op->value, op->count, true);
+    }
+    else {
+        dma_channel_configure(led_bufops_chan, &led_bufops_copy_config, op->dst, op->src, op->count, true);
+    }
+}
+
+/**
+ * @brief DMA interrupt, the operation at the head has finished.
+ * @details Chains straight on to the next one, if any.
+ */
+static void led_bufops_irq_handler(void) {
+    if (led_bufops_chan < 0 || !dma_channel_get_irq0_status(led_bufops_chan)) {
+        return;
+    }
+    dma_channel_acknowledge_irq0(led_bufops_chan);
+    led_bufops_head = (led_bufops_head + 1) % (LED_BUFOPS_QUEUE + 1);
+    led_bufops_queued--;
+    if (led_bufops_queued > 0) {
+        led_bufops_start();
+    }
+    __sev();
+}
+
+/**
+ * @brief Queue an operation, waiting for room if the queue is full.
+ * 
+ * @param op The operation.
+ */
+static void led_bufops_push(const led_bufops_op_t *op) {
+    while (led_bufops_queued > LED_BUFOPS_QUEUE) {
+        __wfe();
+    }
+    uint32_t save = save_and_disable_interrupts();
+    led_bufops_queue[(led_bufops_head + led_bufops_queued) % (LED_BUFOPS_QUEUE + 1)] = *op;
+    led_bufops_queued++;
+    if (led_bufops_queued == 1) {
+        led_bufops_start();
+    }
+    restore_interrupts(save);
+}
+
+bool led_bufops_init(void) {
+    led_bufops_chan = dma_claim_unused_channel(false);
+    if (led_bufops_chan < 0) {
+        return false;
+    }
+    dma_channel_config c = dma_channel_get_default_config(led_bufops_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, DREQ_FORCE);
+    led_bufops_copy_config = c;
+    channel_config_set_read_increment(&c, false);
+    led_bufops_fill_config = c;
+    led_bufops_head = 0;
+    led_bufops_queued = 0;
+
+    irq_add_shared_handler(DMA_IRQ_0, led_bufops_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    dma_channel_set_irq0_enabled(led_bufops_chan, true);
+    irq_set_enabled(DMA_IRQ_0, true);
+    return true;
+}
+
+void led_bufops_deinit(void) {
+    if (led_bufops_chan < 0) {
+        return;
+    }
+    led_bufops_wait();
+    dma_channel_set_irq0_enabled(led_bufops_chan, false);
+    irq_remove_handler(DMA_IRQ_0, led_bufops_irq_handler);
+    dma_channel_unclaim(led_bufops_chan);
+    led_bufops_chan = -1;
+}
+
+void led_bufops_fill(uint32_t *dst, uint32_t value, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (led_bufops_chan < 0) {
+
+        // Four stores a pass, which the compiler can keep in registers.
+        for (; count >= 4; count -= 4, dst += 4) {
+            dst[0] = value;
+            dst[1] = value;
+            dst[2] = value;
+            dst[3] = value;
+        }
+        while (count-- > 0) {
+            *dst++ = value;
+        }
+        return;
+    }
+    led_bufops_op_t op = { dst, NULL, value, count };
+    led_bufops_push(&op);
+}
+
+void led_bufops_copy(uint32_t *dst, const uint32_t *src, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (led_bufops_chan < 0) {
+        memcpy(dst, src, count * sizeof(uint32_t));
+        return;
+    }
+    led_bufops_op_t op = { dst, src, 0, count };
+    led_bufops_push(&op);
+}
+
+void led_bufops_mirror(uint32_t *dst, const uint32_t *src, size_t count) {
+    led_bufops_wait();
+    src += count;
+    for (size_t idx = 0; idx < count; idx++) {
+        *dst++ = *--src;
+    }
+}
+
+bool led_bufops_busy(void) {
+    return led_bufops_queued > 0;
+}
+
+void led_bufops_wait(void) {
+    if (led_bufops_queued > 0) {
+        uint32_t start = time_us_32();
+        while (led_bufops_queued > 0) {
+            __wfe();
+        }
+        led_stats_stall(time_us_32() - start);
+    }
+}
+
+/* End. */
@@ -0,0 +1,90 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Frame buffer fills and copies on a spare DMA channel.
+ *
+ * Each operation is queued and returns straight away. The DMA runs the
+ * queue in order, unpaced, starting each operation from the interrupt that
+ * ends the one before, so a large clear followed by a few stores leaves the
+ * CPU free until the frame is read. Anything that reads a buffer an
+ * operation writes must call led_bufops_wait() first, as led_frames.h and
+ * led_scroll.h do before sending a frame.
+ *
+ * Without a free channel, or before led_bufops_init(), the operations run
+ * on the CPU before returning, which is also how the host benchmark times
+ * them.
+ */
+
+#ifndef LED_BUFOPS_H
+#define LED_BUFOPS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Operations that can be queued behind the one running.
+ */
+#define LED_BUFOPS_QUEUE (4)
+
+/**
+ * @brief Claim a DMA channel for the operations.
+ * 
+ * @return true The operations run on the DMA.
+ * @return false No free channel, they run on the CPU.
+ */
+bool led_bufops_init(void);
+
+/**
+ * @brief Wait for the queue to empty and release the channel.
+ */
+void led_bufops_deinit(void);
+
+/**
+ * @brief Set every word of a buffer to a value.
+ * @details The DMA reads the value from the queue without incrementing, so
+ * nothing but the destination is written.
+ * 
+ * @param dst Destination words.
+ * @param value Value to store.
+ * @param count The number of words.
+ */
+void led_bufops_fill(uint32_t *dst, uint32_t value, size_t count);
+
+/**
+ * @brief Copy words between buffers that do not overlap.
+ * @details The source must not change until the copy has run.
+ * 
+ * @param dst Destination words.
+ * @param src Source words.
+ * @param count The number of words.
+ */
+void led_bufops_copy(uint32_t *dst, const uint32_t *src, size_t count);
+
+/**
+ * @brief Copy words in reverse order, dst[i] = src[count - 1 - i].
+ * @details The DMA only steps addresses upwards, so this waits for the queue
+ * and runs on the CPU. The buffers must not overlap.
+ * 
+ * @param dst Destination words.
+ * @param src Source words.
+ * @param count The number of words.
+ */
+void led_bufops_mirror(uint32_t *dst, const uint32_t *src, size_t count);
+
+/**
+ * @brief Check whether operations are queued or running.
+ * 
+ * @return true The DMA is working through the queue.
+ * @return false Every operation has finished.
+ */
+bool led_bufops_busy(void);
+
+/**
+ * @brief Wait until every queued operation has finished.
+ */
+void led_bufops_wait(void);
+
+#endif // LED_BUFOPS_H
+
+/* End. */
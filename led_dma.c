@@ -0,0 +1,303 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * DMA transmit path for the ws2812 PIO program.
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "led_dma.h"
+#include "led_stats.h"
+
+#define LED_DMA_REPEAT_RING (8)         // log2 of the size of led_dma_repeat[] in bytes.
+
+// Operating data.
+static PIO                      led_dma_pio;                    // PIO running the ws2812 program.
+static uint                     led_dma_sm;                     // State machine being fed.
+static int                      led_dma_chan = -1;              // Claimed DMA channel.
+static int                      led_dma_tail = -1;              // Second channel for the wrapped start of rotated frames.
+static dma_channel_config       led_dma_config;                 // Configuration of the first channel.
+static dma_channel_config       led_dma_chain_config;           // The same, chained to the tail channel.
+static dma_channel_config       led_dma_ring_config;            // The same, reading round led_dma_repeat[].
+static const dma_channel_config *led_dma_loaded = NULL;         // Configuration the first channel has.
+static uint32_t                 led_dma_repeat[LED_DMA_REPEAT_WORDS] __attribute__((aligned(LED_DMA_REPEAT_WORDS * sizeof(uint32_t))));
+static size_t                   led_dma_repeat_block = 0;       // Whole tiles in led_dma_repeat[] (in words).
+static volatile size_t          led_dma_repeat_left = 0;        // Words of a repeated frame still to start.
+static volatile bool            led_dma_active = false;         // Frame on the wire or latching.
+static volatile bool            led_dma_partial = false;        // The transfer is not the end of a frame.
+static volatile bool            led_dma_framing = false;        // A frame has started and not latched.
+static uint32_t                 led_dma_frame_us = 0;           // When the frame started.
+static led_dma_callback_t       led_dma_callback = NULL;        // Completion callback.
+static void                     *led_dma_context = NULL;        // Completion callback context.
+static uint32_t                 led_dma_word_us = LED_DMA_WORD_US; // Time to send one word.
+
+/**
+ * @brief Mark the frame as complete and tell the client.
+ */
+static void led_dma_complete(void) {
+    led_stats_add(LED_STATS_WIRE, time_us_32() - led_dma_frame_us);
+    led_dma_framing = false;
+    led_dma_active = false;
+    if (led_dma_callback != NULL) {
+        led_dma_callback(led_dma_context);
+    }
+    __sev();
+}
+
+/**
+ * @brief Alarm fired once the FIFO has drained and the LEDs have latched.
+ * 
+ * @param id Alarm identifier.
+ * @param user_data Unused.
+ * @return int64_t 0, do not reschedule.
+ */
+static int64_t led_dma_latch_alarm(alarm_id_t id, void *user_data) {
+    led_dma_complete();
+    return 0;
+}
+
+/**
+ * @brief DMA interrupt, the last word has been written to the TX FIFO.
+ * @details The FIFO and OSR still hold words, so allow them to drain and the
+ * line to stay low for the latch time before reporting completion.
+ */
+static void led_dma_irq_handler(void) {
+    if (led_dma_chan < 0) {
+        return;
+    }
+    if (dma_channel_get_irq0_status(led_dma_chan)) {
+        dma_channel_acknowledge_irq0(led_dma_chan);
+    }
+    else if (led_dma_tail >= 0 && dma_channel_get_irq0_status(led_dma_tail)) {
+        dma_channel_acknowledge_irq0(led_dma_tail);
+    }
+    else {
+        return;
+    }
+
+    // Tiles that do not divide the ring are sent a buffer at a time.
+    if (led_dma_repeat_left > 0) {
+        size_t count = (led_dma_repeat_left < led_dma_repeat_block) ? led_dma_repeat_left : led_dma_repeat_block;
+        led_dma_repeat_left -= count;
+        dma_channel_transfer_from_buffer_now(led_dma_chan, led_dma_repeat, count);
+        return;
+    }
+
+    // More of the frame follows, the next part must start before the FIFO
+    // drains so the LEDs do not latch.
+    if (led_dma_partial) {
+        led_dma_active = false;
+        __sev();
+        return;
+    }
+    uint32_t hold_us = (pio_sm_get_tx_fifo_level(led_dma_pio, led_dma_sm) + 1) * led_dma_word_us + LED_DMA_LATCH_US;
+    if (add_alarm_in_us(hold_us, led_dma_latch_alarm, NULL, false) <= 0) {
+        led_dma_complete();
+    }
+}
+
+/**
+ * @brief Mark a transfer as started, and the frame with it if it is the
+ * first part.
+ * 
+ * @param last True if the transfer ends the frame.
+ */
+static void led_dma_begin(bool last) {
+    if (led_dma_framing == false) {
+        led_dma_frame_us = time_us_32();
+        led_dma_framing = true;
+    }
+    led_dma_partial = !last;
+    led_dma_active = true;
+}
+
+/**
+ * @brief Build the configuration for 32 bit reads from memory, written to
+ * the TX FIFO at the rate the SM pulls.
+ * 
+ * @param chan The channel.
+ * @param bswap True to reverse the bytes of each word.
+ * @return dma_channel_config The configuration.
+ */
+static dma_channel_config led_dma_channel_config(uint chan, bool bswap) {
+    dma_channel_config c = dma_channel_get_default_config(chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_bswap(&c, bswap);
+    channel_config_set_dreq(&c, pio_get_dreq(led_dma_pio, led_dma_sm, true));
+    return c;
+}
+
+/**
+ * @brief Load a configuration into the first channel, if it is not there.
+ * 
+ * @param config The configuration.
+ */
+static void led_dma_load(const dma_channel_config *config) {
+    if (led_dma_loaded != config) {
+        dma_channel_set_config(led_dma_chan, config, false);
+        led_dma_loaded = config;
+    }
+}
+
+/**
+ * @brief Configure the channels.
+ * @details The first channel sends frames. For a rotated frame it sends the
+ * end of the buffer with its interrupt quiet and triggers the tail channel,
+ * which sends the start and raises the interrupt. For a repeated tile it
+ * reads round the aligned led_dma_repeat[] buffer.
+ * 
+ * @param bswap True to reverse the bytes of each word.
+ */
+static void led_dma_configure(bool bswap) {
+    led_dma_config = led_dma_channel_config(led_dma_chan, bswap);
+    dma_channel_configure(led_dma_chan, &led_dma_config, &led_dma_pio->txf[led_dma_sm], NULL, 0, false);
+    led_dma_loaded = &led_dma_config;
+    led_dma_ring_config = led_dma_config;
+    channel_config_set_ring(&led_dma_ring_config, false, LED_DMA_REPEAT_RING);
+    if (led_dma_tail >= 0) {
+        dma_channel_config c = led_dma_channel_config(led_dma_tail, bswap);
+        dma_channel_configure(led_dma_tail, &c, &led_dma_pio->txf[led_dma_sm], NULL, 0, false);
+        led_dma_chain_config = led_dma_config;
+        channel_config_set_chain_to(&led_dma_chain_config, led_dma_tail);
+        channel_config_set_irq_quiet(&led_dma_chain_config, true);
+    }
+}
+
+bool led_dma_init(PIO pio, uint sm) {
+    led_dma_chan = dma_claim_unused_channel(false);
+    if (led_dma_chan < 0) {
+        return false;
+    }
+    led_dma_pio = pio;
+    led_dma_sm = sm;
+
+    // Rotated frames are sent in two parts without the tail channel.
+    led_dma_tail = dma_claim_unused_channel(false);
+    led_dma_configure(false);
+
+    irq_add_shared_handler(DMA_IRQ_0, led_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    dma_channel_set_irq0_enabled(led_dma_chan, true);
+    if (led_dma_tail >= 0) {
+        dma_channel_set_irq0_enabled(led_dma_tail, true);
+    }
+    irq_set_enabled(DMA_IRQ_0, true);
+    return true;
+}
+
+void led_dma_deinit(void) {
+    if (led_dma_chan < 0) {
+        return;
+    }
+    led_dma_wait();
+    dma_channel_set_irq0_enabled(led_dma_chan, false);
+    if (led_dma_tail >= 0) {
+        dma_channel_set_irq0_enabled(led_dma_tail, false);
+        dma_channel_unclaim(led_dma_tail);
+        led_dma_tail = -1;
+    }
+    irq_remove_handler(DMA_IRQ_0, led_dma_irq_handler);
+    dma_channel_unclaim(led_dma_chan);
+    led_dma_chan = -1;
+}
+
+void led_dma_set_bswap(bool bswap) {
+    led_dma_wait();
+    led_dma_configure(bswap);
+}
+
+void led_dma_set_word_us(uint32_t word_us) {
+    led_dma_word_us = (word_us > 0) ? word_us : LED_DMA_WORD_US;
+}
+
+void led_dma_set_callback(led_dma_callback_t callback, void *context) {
+    led_dma_callback = callback;
+    led_dma_context = context;
+}
+
+void led_dma_start(const uint32_t *words, size_t count) {
+    led_dma_start_part(words, count, true);
+}
+
+void led_dma_start_part(const uint32_t *words, size_t count, bool last) {
+    led_dma_wait();
+    if (count == 0) {
+        return;
+    }
+    led_dma_load(&led_dma_config);
+    led_dma_begin(last);
+    dma_channel_transfer_from_buffer_now(led_dma_chan, words, count);
+}
+
+void led_dma_start_rotated(const uint32_t *words, size_t count, size_t offset) {
+    if (count == 0 || offset % count == 0) {
+        led_dma_start(words, count);
+        return;
+    }
+    offset %= count;
+    if (led_dma_tail < 0) {
+        led_dma_start_part(words + offset, count - offset, false);
+        led_dma_start_part(words, offset, true);
+        return;
+    }
+
+    // The tail channel is armed with the start of the buffer and triggered
+    // by the first as it finishes, with no gap between them on the wire.
+    led_dma_wait();
+    dma_channel_set_read_addr(led_dma_tail, words, false);
+    dma_channel_set_trans_count(led_dma_tail, offset, false);
+    led_dma_load(&led_dma_chain_config);
+    led_dma_begin(true);
+    dma_channel_transfer_from_buffer_now(led_dma_chan, words + offset, count - offset);
+}
+
+bool led_dma_start_repeat(const uint32_t *tile, size_t tile_size, size_t count) {
+    if (tile_size == 0 || tile_size > LED_DMA_REPEAT_WORDS) {
+        return false;
+    }
+    led_dma_wait();
+
+    // Fill the buffer with as many whole tiles as fit, so each read of it
+    // sends as much of the string as possible.
+    size_t block = (LED_DMA_REPEAT_WORDS / tile_size) * tile_size;
+    for (size_t idx = 0, src = 0; idx < block; idx++) {
+        led_dma_repeat[idx] = tile[src];
+        if (++src == tile_size) {
+            src = 0;
+        }
+    }
+    if (count == 0) {
+        return true;
+    }
+    led_dma_begin(true);
+
+    // A tile that divides the buffer is read round the ring in one transfer,
+    // any other is restarted from the interrupt each time the buffer is sent.
+    if (block == LED_DMA_REPEAT_WORDS) {
+        led_dma_load(&led_dma_ring_config);
+        dma_channel_transfer_from_buffer_now(led_dma_chan, led_dma_repeat, count);
+    }
+    else {
+        size_t first = (count < block) ? count : block;
+        led_dma_load(&led_dma_config);
+        led_dma_repeat_block = block;
+        led_dma_repeat_left = count - first;
+        dma_channel_transfer_from_buffer_now(led_dma_chan, led_dma_repeat, first);
+    }
+    return true;
+}
+
+void led_dma_wait(void) {
+    if (led_dma_active) {
+        uint32_t start = time_us_32();
+        while (led_dma_active) {
+            __wfe();
+        }
+        led_stats_stall(time_us_32() - start);
+    }
+}
+
+/* End. */
@@ -0,0 +1,142 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * DMA transmit path for the ws2812 PIO program.
+ */
+
+#ifndef LED_DMA_H
+#define LED_DMA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hardware/pio.h"
+
+/**
+ * @brief Time taken to send one 24 bit pixel at 800kHz (in us).
+ */
+#define LED_DMA_WORD_US  (30)
+
+/**
+ * @brief Time the line is held low after a frame so the LEDs latch (in us).
+ * @details The WS2812 requires 50us, newer WS2812b parts require 280us.
+ */
+#define LED_DMA_LATCH_US (300)
+
+/**
+ * @brief The longest tile led_dma_start_repeat() repeats (in words).
+ */
+#define LED_DMA_REPEAT_WORDS (64)
+
+/**
+ * @brief Called (from interrupt context) when a frame has been sent and latched.
+ */
+typedef void (*led_dma_callback_t)(void *context);
+
+/**
+ * @brief Claim a DMA channel paced by the state machine TX DREQ.
+ * @details A second channel is claimed, if one is free, for the wrapped
+ * start of the frames sent by led_dma_start_rotated().
+ * 
+ * @param pio PIO handle.
+ * @param sm State machine identifier (already running the ws2812 program).
+ * @return true The DMA path is ready.
+ * @return false No DMA channel, use the blocking path.
+ */
+bool led_dma_init(PIO pio, uint sm);
+
+/**
+ * @brief Wait for the current frame and release the DMA channels.
+ */
+void led_dma_deinit(void);
+
+/**
+ * @brief Reverse the bytes of each word on its way to the TX FIFO.
+ * @details For byte streams such as the packed frames of led_packed.h, whose
+ * first byte in memory is the least significant of a word but must be sent
+ * first. Waits for the current frame.
+ * 
+ * @param bswap True to swap, false (the default) for words in wire format.
+ */
+void led_dma_set_bswap(bool bswap);
+
+/**
+ * @brief Set the time one word takes on the wire.
+ * @details Used to hold the latch until the FIFO has drained, for timing
+ * profiles other than the default 800kHz.
+ * 
+ * @param word_us Time per word (in us), 0 for LED_DMA_WORD_US.
+ */
+void led_dma_set_word_us(uint32_t word_us);
+
+/**
+ * @brief Set the function called when each frame completes.
+ * 
+ * @param callback Completion callback, or NULL for none.
+ * @param context Passed to the callback.
+ */
+void led_dma_set_callback(led_dma_callback_t callback, void *context);
+
+/**
+ * @brief Start sending words that are already in wire format (left aligned).
+ * @details The caller must not modify the words until the frame completes.
+ * 
+ * @param words Pointer to the words to send.
+ * @param count The number of words to send.
+ */
+void led_dma_start(const uint32_t *words, size_t count);
+
+/**
+ * @brief Start sending part of a frame that is already in wire format.
+ * @details Waits for the previous part (or frame). Parts other than the last
+ * complete as soon as their words are in the TX FIFO, with no latch, so the
+ * caller must start the next part within a few pixel times. The last part
+ * completes once the frame has latched, as led_dma_start() does.
+ * 
+ * @param words Pointer to the words to send.
+ * @param count The number of words to send.
+ * @param last True for the end of the frame.
+ */
+void led_dma_start_part(const uint32_t *words, size_t count, bool last);
+
+/**
+ * @brief Start sending a frame from an offset, wrapping round to the start.
+ * @details Pixel i of the string gets words[(offset + i) % count], so moving
+ * the offset scrolls the frame along the string without touching the words.
+ * Two chained channels send the end and then the start of the buffer, with
+ * no CPU time per pixel. Without a second channel the two parts are started
+ * one after the other as led_dma_start_part() does.
+ * 
+ * @param words Pointer to the words to send.
+ * @param count The number of words to send.
+ * @param offset Index of the word sent first.
+ */
+void led_dma_start_rotated(const uint32_t *words, size_t count, size_t offset);
+
+/**
+ * @brief Start sending a frame that repeats a short tile along the string.
+ * @details Pixel i of the string gets tile[i % tile_size]. The tile is
+ * copied, repeated, into a small aligned buffer which the DMA reads over and
+ * over, so no frame buffer is written. Tiles that divide the buffer (1, 2,
+ * 4 ... words, including solid colours) are read round it as a ring in one
+ * transfer. Other tiles cost one interrupt each time the buffer has been
+ * sent. The tile may be rewritten as soon as this returns.
+ * 
+ * @param tile The tile, in wire format.
+ * @param tile_size Words in the tile, up to LED_DMA_REPEAT_WORDS.
+ * @param count The number of words to send.
+ * @return true The frame has started.
+ * @return false The tile is too long, nothing was sent.
+ */
+bool led_dma_start_repeat(const uint32_t *tile, size_t tile_size, size_t count);
+
+/**
+ * @brief Wait until the current frame has been sent and latched.
+ * @details The time waited is counted as blocked (see led_stats.h).
+ */
+void led_dma_wait(void);
+
+#endif // LED_DMA_H
+
+/* End. */
@@ -0,0 +1,493 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Double/triple buffered frame pipeline for the LED string.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "led_bufops.h"
+#include "led_dma.h"
+#include "led_frames.h"
+#include "led_gamma.h"
+#include "led_stats.h"
+#include "led_wire.h"
+#if LED_DUAL_CORE
+#include "pico/multicore.h"
+#endif
+
+#define LED_FRAME_NONE (-1)
+#define LED_FRAME_REPEAT (-2)           // A repeated tile is on the wire, no buffer.
+#define LED_FRAME_FLUSH (0x80000000u)   // Inter-core request (and reply) to drain the wire.
+
+// Operating data.
+static PIO                      led_frames_pio;                 // PIO running the ws2812 program.
+static uint                     led_frames_sm;                  // State machine being fed.
+static bool                     led_frames_dma = false;         // Frames are sent by DMA.
+static uint32_t                 *led_frames_buf[LED_FRAMES_MAX];// The frame buffers.
+static size_t                   led_frames_count = 0;           // Number of frame buffers.
+static size_t                   led_frames_pixels = 0;          // Pixels per frame buffer.
+static int                      led_frames_back_id = LED_FRAME_NONE;  // Buffer being rendered.
+static volatile int             led_frames_front_id = LED_FRAME_NONE; // Buffer on the wire.
+static volatile int             led_frames_queue[LED_FRAMES_MAX];     // Buffers waiting to be sent.
+static volatile size_t          led_frames_queued = 0;          // Entries in the queue.
+static volatile uint32_t        led_frames_free = 0;            // Bit mask of free buffers.
+static led_frames_writer_t      led_frames_writer = NULL;       // Writer used without DMA.
+static uint32_t                 *led_frames_shadow = NULL;      // Last frame sent, as sent.
+static bool                     led_frames_shadowed = false;    // The shadow holds a frame.
+static volatile size_t          led_frames_len[LED_FRAMES_MAX]; // Pixels to send from each buffer.
+static volatile bool            led_frames_wire[LED_FRAMES_MAX];// Buffer was rendered in wire format.
+static volatile uint32_t        led_frames_sent = 0;            // Frames sent.
+static volatile uint32_t        led_frames_skipped = 0;         // Unchanged frames not sent.
+static led_wire_t               led_frames_tile[LED_DMA_REPEAT_WORDS]; // Tile the LEDs show, repeated.
+static size_t                   led_frames_tile_size = 0;       // Words in the tile, 0 if the LEDs show a frame.
+#if LED_DUAL_CORE
+static bool                     led_frames_core1 = false;       // Core 1 is sending frames.
+#endif
+
+/**
+ * @brief Default writer, push every word to the PIO.
+ * 
+ * @param frame The frame, in wire format.
+ * @param frame_size Pixels in the frame.
+ * @return true Always, the prefix to send is worked out beforehand.
+ */
+static bool led_frames_write_blocking(const uint32_t *frame, size_t frame_size) {
+    for (size_t idx = 0; idx < frame_size; idx++) {
+        led_stats_put_blocking(led_frames_pio, led_frames_sm, frame[idx]);
+    }
+    return true;
+}
+
+/**
+ * @brief Encode a frame in place, unless it was rendered in wire format, and
+ * decide how much of it to send.
+ * @details The LEDs past the last pixel that changed since the previous
+ * frame already show the right colour, so only the prefix up to it is sent,
+ * and nothing at all if the frame is unchanged. Writers other than the
+ * default get the whole frame, as corrected pixels, and decide for
+ * themselves.
+ * 
+ * @param id The buffer.
+ * @return size_t Pixels to send, 0 to skip the frame.
+ */
+static size_t led_frames_prepare(int id) {
+    uint32_t *frame = led_frames_buf[id];
+    if (led_frames_dma || led_frames_writer == led_frames_write_blocking) {
+        if (led_frames_wire[id] == false) {
+            led_wire_encode(frame, frame, led_frames_pixels);
+        }
+    }
+    else {
+        if (led_frames_wire[id]) {
+            led_wire_decode(frame, frame, led_frames_pixels);
+        }
+        else {
+            led_gamma_apply(frame, frame, led_frames_pixels);
+        }
+        return led_frames_pixels;
+    }
+
+    // The LEDs will no longer show a repeated tile.
+    led_frames_tile_size = 0;
+
+    // Nothing is known about the LEDs until the first frame has been sent,
+    // or since a repeated tile, which does not update the shadow.
+    if (led_frames_shadowed == false) {
+        memcpy(led_frames_shadow, frame, led_frames_pixels * sizeof(uint32_t));
+        led_frames_shadowed = true;
+        return led_frames_pixels;
+    }
+    return led_frames_dirty(led_frames_shadow, frame, led_frames_pixels);
+}
+
+#if LED_DUAL_CORE == 0
+/**
+ * @brief Start sending the oldest queued frame, if there is one.
+ * @details Must be called with interrupts disabled or from the DMA callback.
+ */
+static void led_frames_start_next(void) {
+    if (led_frames_queued == 0) {
+        led_frames_front_id = LED_FRAME_NONE;
+        return;
+    }
+    led_frames_front_id = led_frames_queue[0];
+    for (size_t idx = 1; idx < led_frames_queued; idx++) {
+        led_frames_queue[idx - 1] = led_frames_queue[idx];
+    }
+    led_frames_queued--;
+    led_dma_start(led_frames_buf[led_frames_front_id], led_frames_len[led_frames_front_id]);
+}
+
+/**
+ * @brief DMA completion callback, release the front buffer and send the next.
+ * 
+ * @param context Unused.
+ */
+static void led_frames_on_complete(void *context) {
+    if (led_frames_front_id >= 0) {
+        led_frames_free |= 1u << led_frames_front_id;
+    }
+    led_frames_start_next();
+}
+#else
+/**
+ * @brief Core 1 entry point, send each frame core 0 presents.
+ * @details With DMA the next frame is encoded while the previous one is on
+ * the wire, then that buffer is handed back once the new one has started.
+ * A writer is synchronous, so its buffer goes straight back.
+ */
+static void led_frames_core1_main(void) {
+    int sending = LED_FRAME_NONE;
+    while (1) {
+        uint32_t msg = multicore_fifo_pop_blocking();
+
+        // Drain the wire and return everything before acknowledging.
+        if (msg == LED_FRAME_FLUSH) {
+            if (led_frames_dma) {
+                led_dma_wait();
+            }
+            if (sending != LED_FRAME_NONE) {
+                multicore_fifo_push_blocking((uint32_t) sending);
+                sending = LED_FRAME_NONE;
+            }
+            multicore_fifo_push_blocking(LED_FRAME_FLUSH);
+            continue;
+        }
+
+        uint32_t *frame = led_frames_buf[msg];
+        size_t count = led_frames_prepare((int) msg);
+        if (count == 0) {
+            led_frames_skipped++;
+            multicore_fifo_push_blocking(msg);
+        }
+        else if (led_frames_dma) {
+            led_dma_start(frame, count);
+            led_frames_sent++;
+            if (sending != LED_FRAME_NONE) {
+                multicore_fifo_push_blocking((uint32_t) sending);
+            }
+            sending = (int) msg;
+        }
+        else {
+            if (led_frames_writer(frame, count)) {
+                led_frames_sent++;
+            }
+            else {
+                led_frames_skipped++;
+            }
+            multicore_fifo_push_blocking(msg);
+        }
+    }
+}
+
+/**
+ * @brief Collect the buffers core 1 has finished with.
+ * 
+ * @param wait True to wait for at least one message.
+ * @return true A flush acknowledgement was received.
+ * @return false Only buffers were returned.
+ */
+static bool led_frames_core1_collect(bool wait) {
+    bool flushed = false;
+    while (wait || multicore_fifo_rvalid()) {
+        uint32_t msg = multicore_fifo_pop_blocking();
+        if (msg == LED_FRAME_FLUSH) {
+            flushed = true;
+        }
+        else {
+            led_frames_free |= 1u << msg;
+        }
+        wait = false;
+    }
+    return flushed;
+}
+#endif
+
+bool led_frames_init(PIO pio, uint sm, size_t frame_count, size_t frame_size, bool use_dma) {
+    if (frame_count < 2) {
+        frame_count = 2;
+    }
+    else if (frame_count > LED_FRAMES_MAX) {
+        frame_count = LED_FRAMES_MAX;
+    }
+
+    // Without DMA there is nothing to overlap with, one buffer is enough,
+    // unless core 1 is doing the sending.
+    if (use_dma == false && LED_DUAL_CORE == 0) {
+        frame_count = 1;
+    }
+    for (size_t idx = 0; idx < frame_count; idx++) {
+        led_frames_buf[idx] = calloc(sizeof(uint32_t), frame_size);
+        if (led_frames_buf[idx] == NULL) {
+            led_frames_count = idx;
+            led_frames_deinit();
+            return false;
+        }
+    }
+    led_frames_shadow = calloc(sizeof(uint32_t), frame_size);
+    if (led_frames_shadow == NULL) {
+        led_frames_count = frame_count;
+        led_frames_deinit();
+        return false;
+    }
+    led_frames_shadowed = false;
+    led_frames_tile_size = 0;
+    led_frames_sent = 0;
+    led_frames_skipped = 0;
+    led_frames_pio = pio;
+    led_frames_sm = sm;
+    led_frames_dma = use_dma;
+    led_frames_count = frame_count;
+    led_frames_pixels = frame_size;
+    led_frames_back_id = LED_FRAME_NONE;
+    led_frames_front_id = LED_FRAME_NONE;
+    led_frames_queued = 0;
+    led_frames_free = (1u << frame_count) - 1u;
+    led_frames_writer = led_frames_write_blocking;
+#if LED_DUAL_CORE
+
+    // Core 1 waits on each frame itself, so no completion callback.
+    multicore_fifo_drain();
+    multicore_launch_core1(led_frames_core1_main);
+    led_frames_core1 = true;
+#else
+    if (use_dma) {
+        led_dma_set_callback(led_frames_on_complete, NULL);
+    }
+#endif
+    return true;
+}
+
+void led_frames_set_writer(led_frames_writer_t writer) {
+    led_frames_writer = (writer != NULL) ? writer : led_frames_write_blocking;
+}
+
+void led_frames_deinit(void) {
+    led_frames_flush();
+#if LED_DUAL_CORE
+    if (led_frames_core1) {
+        multicore_reset_core1();
+        led_frames_core1 = false;
+    }
+#else
+    if (led_frames_dma) {
+        led_dma_set_callback(NULL, NULL);
+    }
+#endif
+    for (size_t idx = 0; idx < led_frames_count; idx++) {
+        free(led_frames_buf[idx]);
+        led_frames_buf[idx] = NULL;
+    }
+    free(led_frames_shadow);
+    led_frames_shadow = NULL;
+    led_frames_shadowed = false;
+    led_frames_count = 0;
+    led_frames_free = 0;
+}
+
+uint32_t *led_frames_back(void) {
+    if (led_frames_back_id == LED_FRAME_NONE) {
+
+#if LED_DUAL_CORE
+
+        // Wait for core 1 to hand a buffer back.
+        uint32_t start = time_us_32();
+        led_frames_core1_collect(led_frames_free == 0);
+        led_stats_stall(time_us_32() - start);
+#else
+
+        // Wait for the DMA callback to release a buffer.
+        if (led_frames_free == 0) {
+            uint32_t start = time_us_32();
+            while (led_frames_free == 0) {
+                __wfe();
+            }
+            led_stats_stall(time_us_32() - start);
+        }
+#endif
+        uint32_t save = save_and_disable_interrupts();
+        for (int idx = 0; idx < (int) led_frames_count; idx++) {
+            if (led_frames_free & (1u << idx)) {
+                led_frames_free &= ~(1u << idx);
+                led_frames_back_id = idx;
+                break;
+            }
+        }
+        restore_interrupts(save);
+    }
+    return led_frames_buf[led_frames_back_id];
+}
+
+/**
+ * @brief Queue the back buffer for transmission.
+ * 
+ * @param wire True if it was rendered in wire format.
+ */
+static void led_frames_present(bool wire) {
+    uint32_t *frame = led_frames_back();
+    led_bufops_wait();
+    led_frames_wire[led_frames_back_id] = wire;
+
+#if LED_DUAL_CORE
+
+    // Core 1 corrects, encodes and sends it.
+    (void) frame;
+    multicore_fifo_push_blocking((uint32_t) led_frames_back_id);
+    led_frames_back_id = LED_FRAME_NONE;
+#else
+
+    // Writer path, the single buffer is free again on return.
+    if (led_frames_dma == false) {
+        size_t count = led_frames_prepare(led_frames_back_id);
+        if (count > 0 && led_frames_writer(frame, count)) {
+            led_frames_sent++;
+        }
+        else {
+            led_frames_skipped++;
+        }
+        return;
+    }
+
+    // The buffer now belongs to the DMA, so encode it in place.
+    size_t count = led_frames_prepare(led_frames_back_id);
+
+    uint32_t save = save_and_disable_interrupts();
+    if (count == 0) {
+
+        // Unchanged, so the buffer is free again straight away.
+        led_frames_free |= 1u << led_frames_back_id;
+        led_frames_skipped++;
+    }
+    else {
+        led_frames_len[led_frames_back_id] = count;
+        led_frames_queue[led_frames_queued++] = led_frames_back_id;
+        led_frames_sent++;
+        if (led_frames_front_id == LED_FRAME_NONE) {
+            led_frames_start_next();
+        }
+    }
+    led_frames_back_id = LED_FRAME_NONE;
+    restore_interrupts(save);
+#endif
+}
+
+led_wire_t *led_frames_back_wire(void) {
+    return led_frames_back();
+}
+
+void led_frames_swap(void) {
+    led_frames_present(false);
+}
+
+void led_frames_swap_wire(void) {
+    led_frames_present(true);
+}
+
+/**
+ * @brief Check whether the LEDs already show a repeated tile.
+ * 
+ * @param tile The tile.
+ * @param tile_size Words in the tile.
+ * @return true The same tile was the last thing sent.
+ * @return false Something else was.
+ */
+static bool led_frames_tile_shown(const led_wire_t *tile, size_t tile_size) {
+    if (tile_size != led_frames_tile_size) {
+        return false;
+    }
+    return memcmp(tile, led_frames_tile, tile_size * sizeof(led_wire_t)) == 0;
+}
+
+void led_frames_repeat(const led_wire_t *tile, size_t tile_size) {
+#if LED_DUAL_CORE == 0
+    bool direct = (led_frames_dma || led_frames_writer == led_frames_write_blocking);
+#else
+    bool direct = false;
+#endif
+    if (direct && tile_size > 0 && tile_size <= LED_DMA_REPEAT_WORDS) {
+        if (led_frames_tile_shown(tile, tile_size)) {
+            led_frames_skipped++;
+            return;
+        }
+
+        // The queue drains first, then the tile goes out with no buffer and
+        // the frames presented after it wait for it in the queue.
+        led_frames_flush();
+        memcpy(led_frames_tile, tile, tile_size * sizeof(led_wire_t));
+        led_frames_tile_size = tile_size;
+        led_frames_shadowed = false;
+        led_frames_sent++;
+        if (led_frames_dma) {
+            led_frames_front_id = LED_FRAME_REPEAT;
+            led_dma_start_repeat(tile, tile_size, led_frames_pixels);
+        }
+        else {
+            for (size_t idx = 0, src = 0; idx < led_frames_pixels; idx++) {
+                led_stats_put_blocking(led_frames_pio, led_frames_sm, tile[src]);
+                if (++src == tile_size) {
+                    src = 0;
+                }
+            }
+        }
+        return;
+    }
+
+    // Writers and core 1 take whole frames, so expand the tile into one.
+    led_wire_t *frame = led_frames_back_wire();
+    for (size_t idx = 0; idx < led_frames_pixels; idx++) {
+        frame[idx] = tile[idx % tile_size];
+    }
+    led_frames_swap_wire();
+}
+
+void led_frames_flush(void) {
+    uint32_t start = time_us_32();
+#if LED_DUAL_CORE
+    if (led_frames_core1) {
+        multicore_fifo_push_blocking(LED_FRAME_FLUSH);
+        while (led_frames_core1_collect(true) == false) {
+        }
+        led_stats_stall(time_us_32() - start);
+        return;
+    }
+#endif
+    if (led_frames_dma) {
+        while (led_frames_queued != 0 || led_frames_front_id != LED_FRAME_NONE) {
+            __wfe();
+        }
+    }
+    led_stats_stall(time_us_32() - start);
+}
+
+size_t led_frames_dirty(uint32_t *shadow, const uint32_t *frame, size_t count) {
+
+    // Search back from the end for the last change.
+    size_t dirty = count;
+    while (dirty > 0 && frame[dirty - 1] == shadow[dirty - 1]) {
+        dirty--;
+    }
+    memcpy(shadow, frame, dirty * sizeof(uint32_t));
+    return dirty;
+}
+
+void led_frames_get_stats(led_frames_stats_t *stats) {
+    stats->sent = led_frames_sent;
+    stats->skipped = led_frames_skipped;
+}
+
+void led_frames_reset_stats(void) {
+    uint32_t save = save_and_disable_interrupts();
+    led_frames_sent = 0;
+    led_frames_skipped = 0;
+    restore_interrupts(save);
+}
+
+size_t led_frames_size(void) {
+    return led_frames_pixels;
+}
+
+/* End. */
@@ -0,0 +1,175 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Double/triple buffered frame pipeline for the LED string.
+ */
+
+#ifndef LED_FRAMES_H
+#define LED_FRAMES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hardware/pio.h"
+#include "led_wire.h"
+
+/**
+ * @brief The largest number of frame buffers that can be managed.
+ */
+#define LED_FRAMES_MAX (3)
+
+/**
+ * @brief Send frames from core 1 (1) or from the rendering core (0).
+ * @details When set, led_frames_init() launches core 1, which gamma
+ * corrects, encodes or transposes each presented frame and starts it on the
+ * wire, while core 0 renders the next frame and handles input. Buffers are
+ * passed between the cores through the inter-core FIFOs, and at least two
+ * buffers are used even without DMA.
+ */
+#ifndef LED_DUAL_CORE
+#define LED_DUAL_CORE (0)
+#endif
+
+/**
+ * @brief Sends a frame when frames are not queued for DMA.
+ * @details Returns once the frame may be rewritten, true if the frame was
+ * sent or false if it was skipped as unchanged.
+ */
+typedef bool (*led_frames_writer_t)(const uint32_t *frame, size_t frame_size);
+
+/**
+ * @brief Frame counters since led_frames_init().
+ */
+typedef struct led_frames_stats_s {
+    uint32_t sent;                      // Frames sent, in full or in part.
+    uint32_t skipped;                   // Frames identical to the last one, not sent.
+} led_frames_stats_t;
+
+/**
+ * @brief Allocate the frame buffers.
+ * @details With DMA each presented frame is queued and the buffers rotate as
+ * each transmit completes. Without DMA a single buffer is used and presenting
+ * a frame passes it to the writer, by default blocking until it has been
+ * pushed to the PIO. Either way the pixels are gamma corrected on the way,
+ * and writers are given the corrected pixels. With LED_DUAL_CORE the writer
+ * and DMA are driven from core 1.
+ *
+ * WS2812 LEDs keep their colour when a frame is cut short, so the DMA and
+ * default writer paths send only the pixels up to the last one that changed
+ * since the previous frame, and a frame that has not changed at all is not
+ * sent. A writer set with led_frames_set_writer() is given the whole frame
+ * and can use led_frames_dirty() itself.
+ * 
+ * @param pio PIO handle.
+ * @param sm State machine identifier.
+ * @param frame_count Number of buffers, 2 (double) or 3 (triple).
+ * @param frame_size Number of pixels in each buffer.
+ * @param use_dma True if led_dma_init() succeeded.
+ * @return true The buffers are ready.
+ * @return false Allocation failed.
+ */
+bool led_frames_init(PIO pio, uint sm, size_t frame_count, size_t frame_size, bool use_dma);
+
+/**
+ * @brief Replace the writer used when frames are not queued for DMA.
+ * 
+ * @param writer The writer, or NULL for blocking PIO writes.
+ */
+void led_frames_set_writer(led_frames_writer_t writer);
+
+/**
+ * @brief Wait for all queued frames and free the buffers.
+ * @details With LED_DUAL_CORE core 1 is stopped as well.
+ */
+void led_frames_deinit(void);
+
+/**
+ * @brief Get the buffer the next frame should be rendered into.
+ * @details Waits until a buffer is free. The contents are undefined, so
+ * every pixel must be written before calling led_frames_swap(). Calling this
+ * again before swapping returns the same buffer.
+ * 
+ * @return uint32_t* The back buffer of rgb_u32() pixels.
+ */
+uint32_t *led_frames_back(void);
+
+/**
+ * @brief Queue the back buffer for transmission.
+ * @details The buffer becomes the front buffer when the frame ahead of it
+ * has been sent, and returns to the free pool once it has been sent itself.
+ */
+void led_frames_swap(void);
+
+/**
+ * @brief Get the back buffer to render a frame in wire format.
+ * @details The same buffer as led_frames_back(), for a frame that converts
+ * its own pixels with the led_wire.h helpers. It must be presented with
+ * led_frames_swap_wire().
+ * 
+ * @return led_wire_t* The back buffer of wire words.
+ */
+led_wire_t *led_frames_back_wire(void);
+
+/**
+ * @brief Queue a back buffer rendered in wire format for transmission.
+ * @details The frame is not encoded again, so with DMA it goes to the wire
+ * as it was rendered, only read to find the pixels that changed.
+ */
+void led_frames_swap_wire(void);
+
+/**
+ * @brief Send a frame that repeats a short tile of wire words.
+ * @details Pixel i gets tile[i % tile_size]. With DMA, or the default
+ * writer, the frames already queued are sent first and the tile is then
+ * sent without a frame buffer (see led_dma_start_repeat()), and not at all
+ * if it is the tile last sent. The frame after it is sent in full. With
+ * other writers, LED_DUAL_CORE or a tile longer than LED_DMA_REPEAT_WORDS,
+ * the tile is expanded into the back buffer and presented as
+ * led_frames_swap_wire() does.
+ * 
+ * @param tile The tile, in wire format.
+ * @param tile_size Words in the tile, at least 1.
+ */
+void led_frames_repeat(const led_wire_t *tile, size_t tile_size);
+
+/**
+ * @brief Wait until every queued frame has been sent.
+ */
+void led_frames_flush(void);
+
+/**
+ * @brief Find the prefix of a frame that differs from the last one sent.
+ * @details Compares against the shadow copy from the end and updates the
+ * changed part of the shadow, so it tracks what the LEDs show.
+ * 
+ * @param shadow The last frame sent, updated to the new frame.
+ * @param frame The new frame.
+ * @param count The number of pixels.
+ * @return size_t The pixels up to and including the last that changed, 0 if
+ * the frames are the same.
+ */
+size_t led_frames_dirty(uint32_t *shadow, const uint32_t *frame, size_t count);
+
+/**
+ * @brief Get the frame counters.
+ * 
+ * @param stats Filled with the counters.
+ */
+void led_frames_get_stats(led_frames_stats_t *stats);
+
+/**
+ * @brief Clear the frame counters, at the start of a pattern.
+ */
+void led_frames_reset_stats(void);
+
+/**
+ * @brief Get the number of pixels in each buffer.
+ * 
+ * @return size_t Pixels per frame.
+ */
+size_t led_frames_size(void);
+
+#endif // LED_FRAMES_H
+
+/* End. */
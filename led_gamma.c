@@ -0,0 +1,36 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Gamma correction and global brightness for LED frames.
+ */
+
+#include "led_gamma.h"
+#include "led_gamma_table.h"
+
+// Operating data.
+static const uint16_t           led_gamma_curve[256] = LED_GAMMA_CURVE16;       // Full scale 16 bit curve (flash).
+static uint8_t                  led_gamma_brightness = LED_GAMMA_BRIGHTNESS;    // Current brightness.
+uint8_t                         led_gamma_lut[256] = LED_GAMMA_TABLE;           // Curve at the brightness (RAM).
+
+void led_gamma_apply(uint32_t *dst, const uint32_t *src, size_t count) {
+    for (size_t idx = 0; idx < count; idx++) {
+        *dst++ = led_gamma_pixel(*src++);
+    }
+}
+
+void led_gamma_set_brightness(uint8_t brightness) {
+
+    // Scale the 16 bit curve and round once, as led_gamma.py does, so the
+    // build time brightness gives back the build time table and low values
+    // keep their resolution when dimmed.
+    for (size_t idx = 0; idx < 256; idx++) {
+        led_gamma_lut[idx] = (uint8_t) ((led_gamma_curve[idx] * (uint32_t) brightness + 32767u) / 65535u);
+    }
+    led_gamma_brightness = brightness;
+}
+
+uint8_t led_gamma_get_brightness(void) {
+    return led_gamma_brightness;
+}
+
+/* End. */
@@ -0,0 +1,63 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Gamma correction and global brightness for LED frames.
+ *
+ * Patterns render full range, linear 8 bit channels. Each channel is mapped
+ * through a 256 entry table in RAM as the frame is encoded, so correction
+ * and dimming cost one lookup per channel. The table is generated at build
+ * time by led_gamma.py (LED_GAMMA and LED_BRIGHTNESS in CMake) and can be
+ * rebuilt for a new brightness at run time. Both scale the same 16 bit
+ * full scale curve and round once, so they give the same table.
+ */
+
+#ifndef LED_GAMMA_H
+#define LED_GAMMA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Channel lookup table, gamma corrected and scaled by the brightness.
+ */
+extern uint8_t led_gamma_lut[256];
+
+/**
+ * @brief Correct one rgb_u32() pixel.
+ * 
+ * @param pixel The linear pixel.
+ * @return uint32_t The corrected pixel.
+ */
+static inline uint32_t led_gamma_pixel(uint32_t pixel) {
+    return ((uint32_t) led_gamma_lut[(pixel >> 16) & 0xffu] << 16) |
+           ((uint32_t) led_gamma_lut[(pixel >> 8) & 0xffu] << 8) |
+           (uint32_t) led_gamma_lut[pixel & 0xffu];
+}
+
+/**
+ * @brief Correct an array of rgb_u32() pixels.
+ * 
+ * @param dst Destination pixels, may be the same as src.
+ * @param src Source pixels.
+ * @param count The number of pixels.
+ */
+void led_gamma_apply(uint32_t *dst, const uint32_t *src, size_t count);
+
+/**
+ * @brief Rebuild the lookup table for a new global brightness.
+ * @details Frames already encoded are not affected.
+ * 
+ * @param brightness Full scale output, 0 (off) to 255.
+ */
+void led_gamma_set_brightness(uint8_t brightness);
+
+/**
+ * @brief Get the global brightness.
+ * 
+ * @return uint8_t Full scale output, 0 to 255.
+ */
+uint8_t led_gamma_get_brightness(void);
+
+#endif // LED_GAMMA_H
+
+/* End. */
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+#
+# SPDX-License-Identifier: BSD-3-Clause
+
+"""Generates the gamma and brightness tables used when LED frames are encoded."""
+
+import argparse
+import sys
+
+
+def curve(gamma):
+    """Map a linear 8 bit value to a gamma corrected 16 bit value."""
+    return [int(round(65535 * (idx / 255.0) ** gamma)) for idx in range(256)]
+
+
+def scale(values, brightness):
+    """Dim the 16 bit curve to 8 bits, rounding once, as led_gamma_set_brightness() does."""
+    return [(val * brightness + 32767) // 65535 for val in values]
+
+
+def table(values, width=3):
+    """Format the values as a C initialiser, 16 to a line."""
+    rows = []
+    for idx in range(0, len(values), 16):
+        rows.append("    " + ", ".join("%*d" % (width, val) for val in values[idx:idx + 16]) + ", \\")
+    return "{ \\\n" + "\n".join(rows) + "\n}"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--gamma", type=float, default=2.8, help="gamma exponent")
+    parser.add_argument("--brightness", type=int, default=32, help="full scale output, 1 to 255")
+    parser.add_argument("-o", "--output", help="header to write, stdout if omitted")
+    args = parser.parse_args()
+    if args.gamma <= 0 or not 1 <= args.brightness <= 255:
+        parser.error("gamma must be positive and brightness 1 to 255")
+
+    text = """/**
+ * Generated by led_gamma.py, do not edit.
+ *
+ * Gamma %.2f, brightness %d.
+ */
+
+#ifndef LED_GAMMA_TABLE_H
+#define LED_GAMMA_TABLE_H
+
+#define LED_GAMMA_VALUE      (%.2f)
+#define LED_GAMMA_BRIGHTNESS (%d)
+
+// Gamma curve at full scale, 16 bit.
+#define LED_GAMMA_CURVE16 %s
+
+// Gamma curve at LED_GAMMA_BRIGHTNESS.
+#define LED_GAMMA_TABLE %s
+
+#endif // LED_GAMMA_TABLE_H
+""" % (args.gamma, args.brightness, args.gamma, args.brightness,
+       table(curve(args.gamma), 5), table(scale(curve(args.gamma), args.brightness)))
+
+    if args.output:
+        with open(args.output, "w") as out:
+            out.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()
+
+# End.
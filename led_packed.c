@@ -0,0 +1,100 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Packed 3 byte per pixel frames, sent with a 32 bit pull.
+ */
+
+#include <stdlib.h>
+
+#include "pico/stdlib.h"
+#include "led_dma.h"
+#include "led_gamma.h"
+#include "led_packed.h"
+#include "led_stats.h"
+
+// Operating data.
+static PIO                      led_packed_pio;                 // PIO running the packed ws2812 program.
+static uint                     led_packed_sm;                  // State machine being fed.
+static bool                     led_packed_dma = false;         // Frames are sent by DMA.
+static uint32_t                 *led_packed_buf[2];             // The packed frames, word aligned.
+static size_t                   led_packed_count = 0;           // Number of frames.
+static size_t                   led_packed_pixels = 0;          // Pixels per frame.
+static size_t                   led_packed_back = 0;            // Frame being rendered.
+static uint32_t                 led_packed_tile[LED_STREAM_TILE_MAX]; // Tile being rendered.
+
+bool led_packed_init(PIO pio, uint sm, size_t frame_size, bool use_dma) {
+
+    // Without DMA there is nothing to overlap with, one frame is enough.
+    size_t frame_count = use_dma ? 2 : 1;
+    for (size_t idx = 0; idx < frame_count; idx++) {
+        led_packed_buf[idx] = calloc(sizeof(uint32_t), LED_PACKED_WORDS(frame_size));
+        if (led_packed_buf[idx] == NULL) {
+            led_packed_count = idx;
+            led_packed_deinit();
+            return false;
+        }
+    }
+    led_packed_pio = pio;
+    led_packed_sm = sm;
+    led_packed_dma = use_dma;
+    led_packed_count = frame_count;
+    led_packed_pixels = frame_size;
+    led_packed_back = 0;
+    if (use_dma) {
+        led_dma_set_bswap(true);
+    }
+    return true;
+}
+
+void led_packed_deinit(void) {
+    if (led_packed_dma) {
+        led_dma_set_bswap(false);
+    }
+    for (size_t idx = 0; idx < led_packed_count; idx++) {
+        free(led_packed_buf[idx]);
+        led_packed_buf[idx] = NULL;
+    }
+    led_packed_count = 0;
+}
+
+void led_packed_encode(uint8_t *dst, const uint32_t *src, size_t count) {
+
+    // Most significant (first sent) byte first.
+    for (size_t idx = 0; idx < count; idx++) {
+        uint32_t pixel = led_gamma_pixel(*src++);
+        *dst++ = (uint8_t) (pixel >> 16);
+        *dst++ = (uint8_t) (pixel >> 8);
+        *dst++ = (uint8_t) pixel;
+    }
+}
+
+void led_packed_frame(led_stream_tile_t tile, const void *context, size_t tile_size, uint32_t t) {
+    if (tile_size == 0 || tile_size > LED_STREAM_TILE_MAX) {
+        tile_size = LED_STREAM_TILE_MAX;
+    }
+
+    // The frame two back has been sent, starting the last one waited for it.
+    uint32_t *frame = led_packed_buf[led_packed_back];
+    uint8_t *bytes = (uint8_t *) frame;
+    for (size_t first = 0; first < led_packed_pixels; first += tile_size) {
+        size_t size = led_packed_pixels - first;
+        if (size > tile_size) {
+            size = tile_size;
+        }
+        tile(context, led_packed_tile, first, size, t);
+        led_packed_encode(bytes + first * 3u, led_packed_tile, size);
+    }
+
+    size_t words = LED_PACKED_WORDS(led_packed_pixels);
+    if (led_packed_dma) {
+        led_dma_start(frame, words);
+        led_packed_back = (led_packed_back + 1) % led_packed_count;
+    }
+    else {
+        for (size_t idx = 0; idx < words; idx++) {
+            led_stats_put_blocking(led_packed_pio, led_packed_sm, __builtin_bswap32(frame[idx]));
+        }
+    }
+}
+
+/* End. */
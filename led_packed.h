@@ -0,0 +1,77 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Packed 3 byte per pixel frames, sent with a 32 bit pull.
+ *
+ * A frame is held as the bytes sent on the wire, 3 per pixel with no
+ * padding, so pixels run across word boundaries and a frame takes three
+ * quarters of the RAM (and DMA reads) of one word per pixel. The state
+ * machine pulls 32 bits at a time and the DMA byte swaps each word, so the
+ * bytes go out in memory order. A frame is rendered a tile at a time into a
+ * small buffer and packed behind it, and with DMA two frames are kept so one
+ * is rendered while the other is sent.
+ *
+ * The stream is padded with zero bytes to a whole word. Up to 3 bytes more
+ * than the string needs are shifted out, which the last LED passes on to
+ * nothing.
+ */
+
+#ifndef LED_PACKED_H
+#define LED_PACKED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hardware/pio.h"
+#include "led_stream.h"
+
+/**
+ * @brief Words in a packed frame of the given number of pixels.
+ */
+#define LED_PACKED_WORDS(pixels) (((pixels) * 3u + 3u) / 4u)
+
+/**
+ * @brief Allocate the packed frames.
+ * @details With DMA the channel is switched to byte swapping.
+ * 
+ * @param pio PIO handle.
+ * @param sm State machine identifier, set up by ws2812_packed_program_init().
+ * @param frame_size Number of pixels in each frame.
+ * @param use_dma True if led_dma_init() succeeded.
+ * @return true The frames are ready.
+ * @return false Allocation failed.
+ */
+bool led_packed_init(PIO pio, uint sm, size_t frame_size, bool use_dma);
+
+/**
+ * @brief Wait for the frame on the wire and free the frames.
+ */
+void led_packed_deinit(void);
+
+/**
+ * @brief Pack rgb_u32() pixels into wire bytes.
+ * @details Each channel is gamma corrected and scaled by the global
+ * brightness on the way.
+ * 
+ * @param dst Destination bytes, 3 per pixel.
+ * @param src Source pixels.
+ * @param count The number of pixels.
+ */
+void led_packed_encode(uint8_t *dst, const uint32_t *src, size_t count);
+
+/**
+ * @brief Render a frame a tile at a time, pack it and send it.
+ * @details With DMA returns once the frame has started, otherwise once it
+ * has been pushed to the PIO.
+ * 
+ * @param tile The tile renderer.
+ * @param context Passed to the renderer.
+ * @param tile_size Pixels in each tile, at most LED_STREAM_TILE_MAX.
+ * @param t Frame time, passed to the renderer.
+ */
+void led_packed_frame(led_stream_tile_t tile, const void *context, size_t tile_size, uint32_t t);
+
+#endif // LED_PACKED_H
+
+/* End. */
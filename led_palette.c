@@ -0,0 +1,65 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Palette indexed frames for the LED string.
+ */
+
+#include <stdlib.h>
+
+#include "led_palette.h"
+#include "led_stream.h"
+
+// Operating data.
+static uint8_t                  *led_palette_indices = NULL;    // The index frame.
+static size_t                   led_palette_pixels = 0;         // Pixels in the frame.
+static led_wire_t               led_palette_words[LED_PALETTE_SIZE]; // Palette, in wire format.
+
+/**
+ * @brief Expand a tile of the index frame to wire words.
+ * 
+ * @param context Unused.
+ * @param tile Filled with the wire words.
+ * @param first Index of the first pixel.
+ * @param count Pixels in the tile.
+ * @param t Unused.
+ */
+static void led_palette_expand(const void *context, uint32_t *tile, size_t first, size_t count, uint32_t t) {
+    const uint8_t *indices = led_palette_indices + first;
+    for (size_t idx = 0; idx < count; idx++) {
+        *tile++ = led_palette_words[*indices++];
+    }
+}
+
+bool led_palette_init(size_t frame_size) {
+    led_palette_indices = calloc(1, frame_size);
+    if (led_palette_indices == NULL) {
+        return false;
+    }
+    led_palette_pixels = frame_size;
+    led_wire_fill(led_palette_words, LED_PALETTE_SIZE, led_wire_from_pixel(0));
+    return true;
+}
+
+void led_palette_deinit(void) {
+    free(led_palette_indices);
+    led_palette_indices = NULL;
+    led_palette_pixels = 0;
+}
+
+uint8_t *led_palette_frame(void) {
+    return led_palette_indices;
+}
+
+void led_palette_set(uint8_t index, uint32_t pixel) {
+    led_palette_words[index] = led_wire_from_pixel(pixel);
+}
+
+led_wire_t led_palette_get(uint8_t index) {
+    return led_palette_words[index];
+}
+
+void led_palette_send(size_t tile_size) {
+    led_stream_wire_tiles(led_palette_expand, NULL, tile_size, led_palette_pixels, 0);
+}
+
+/* End. */
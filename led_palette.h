@@ -0,0 +1,86 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Palette indexed frames for the LED string.
+ *
+ * A frame holds one 8 bit palette index per pixel, a quarter of the RAM of
+ * rgb_u32() pixels. The 256 entry palette is held in wire format, so each
+ * pixel is expanded with a single lookup as the frame is sent, a tile at a
+ * time through led_stream.c. Changing a colour for the whole string is one
+ * palette entry, however many pixels use it, which makes colour cycling
+ * cost O(palette) rather than O(pixels).
+ *
+ * The index frame is only read while it is sent, and led_palette_send()
+ * returns once the last tile has started, so a single frame is enough.
+ */
+
+#ifndef LED_PALETTE_H
+#define LED_PALETTE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "led_wire.h"
+
+/**
+ * @brief Number of palette entries.
+ */
+#define LED_PALETTE_SIZE (256)
+
+/**
+ * @brief Allocate the index frame, cleared to index 0, and clear the
+ * palette to black.
+ * @details The stream must be set up with led_stream_init().
+ * 
+ * @param frame_size Number of pixels in the frame.
+ * @return true The frame is ready.
+ * @return false Allocation failed.
+ */
+bool led_palette_init(size_t frame_size);
+
+/**
+ * @brief Free the index frame.
+ */
+void led_palette_deinit(void);
+
+/**
+ * @brief Get the index frame.
+ * @details It keeps its contents between frames, so only the pixels that
+ * change need to be written.
+ * 
+ * @return uint8_t* One palette index per pixel.
+ */
+uint8_t *led_palette_frame(void);
+
+/**
+ * @brief Set a palette entry.
+ * @details The colour is gamma corrected and scaled by the global brightness
+ * as it is stored, so entries must be set again after the brightness
+ * changes.
+ * 
+ * @param index The entry.
+ * @param pixel The rgb_u32() colour.
+ */
+void led_palette_set(uint8_t index, uint32_t pixel);
+
+/**
+ * @brief Get a palette entry.
+ * 
+ * @param index The entry.
+ * @return led_wire_t The entry in wire format.
+ */
+led_wire_t led_palette_get(uint8_t index);
+
+/**
+ * @brief Expand the index frame and send it.
+ * @details Returns once the last tile has started, the frame may then be
+ * changed for the next.
+ * 
+ * @param tile_size Pixels expanded in each tile, at most LED_STREAM_TILE_MAX.
+ */
+void led_palette_send(size_t tile_size);
+
+#endif // LED_PALETTE_H
+
+/* End. */
@@ -0,0 +1,123 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Parallel output to several LED strings with the ws2812_parallel program.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "led_dma.h"
+#include "led_frames.h"
+#include "led_parallel.h"
+#include "led_stats.h"
+#include "led_transpose.h"
+
+// Operating data.
+static PIO                      led_parallel_pio;               // PIO running ws2812_parallel.
+static uint                     led_parallel_sm;                // State machine being fed.
+static uint                     led_parallel_lanes = 0;         // Number of strings.
+static led_transpose_kernel_t   led_parallel_kernel = NULL;     // Kernel for the lane count, NULL for led_transpose_any().
+static size_t                   led_parallel_strip = 0;         // Pixels per string.
+static bool                     led_parallel_dma = false;       // Planes are sent by DMA.
+static uint32_t                 *led_parallel_planes[2] = {NULL, NULL}; // Bit planes, one on the wire, one being filled.
+static uint                     led_parallel_back = 0;          // Planes to transpose the next frame into.
+static uint32_t                 *led_parallel_shadow = NULL;    // Last frame sent.
+static bool                     led_parallel_shadowed = false;  // The shadow holds a frame.
+
+bool led_parallel_init(PIO pio, uint sm, uint lanes, size_t strip_size, bool use_dma) {
+    if (lanes == 0 || lanes > LED_PARALLEL_MAX_LANES) {
+        return false;
+    }
+
+    // With DMA the next frame is transposed while the last is on the wire,
+    // without it the planes are free again once written.
+    led_parallel_planes[0] = calloc(sizeof(uint32_t), strip_size * LED_TRANSPOSE_BITS);
+    led_parallel_planes[1] = use_dma ? calloc(sizeof(uint32_t), strip_size * LED_TRANSPOSE_BITS) : led_parallel_planes[0];
+    led_parallel_shadow = calloc(sizeof(uint32_t), strip_size * lanes);
+    if (led_parallel_planes[0] == NULL || led_parallel_planes[1] == NULL || led_parallel_shadow == NULL) {
+        led_parallel_deinit();
+        return false;
+    }
+    led_parallel_back = 0;
+    led_parallel_shadowed = false;
+    led_parallel_pio = pio;
+    led_parallel_sm = sm;
+    led_parallel_lanes = lanes;
+    led_parallel_kernel = led_transpose_kernel(lanes);
+    led_parallel_strip = strip_size;
+    led_parallel_dma = use_dma;
+
+    // Each word is one bit of every string, so the FIFO drains 24 times
+    // faster than it does with a pixel per word.
+    if (use_dma) {
+        led_dma_set_word_us((LED_DMA_WORD_US + LED_TRANSPOSE_BITS - 1u) / LED_TRANSPOSE_BITS);
+    }
+    return true;
+}
+
+void led_parallel_deinit(void) {
+    if (led_parallel_dma) {
+        led_dma_wait();
+    }
+    if (led_parallel_planes[1] != led_parallel_planes[0]) {
+        free(led_parallel_planes[1]);
+    }
+    free(led_parallel_planes[0]);
+    free(led_parallel_shadow);
+    led_parallel_planes[0] = NULL;
+    led_parallel_planes[1] = NULL;
+    led_parallel_shadow = NULL;
+    led_parallel_lanes = 0;
+}
+
+bool led_parallel_write(const uint32_t *frame, size_t frame_size) {
+    size_t strip_size = frame_size / led_parallel_lanes;
+    if (strip_size > led_parallel_strip) {
+        strip_size = led_parallel_strip;
+    }
+
+    // Every string is clocked together, so send up to the furthest change
+    // along any of them, or nothing if none has changed.
+    size_t send = strip_size;
+    if (led_parallel_shadowed) {
+        send = 0;
+        for (uint lane = 0; lane < led_parallel_lanes; lane++) {
+            size_t dirty = led_frames_dirty(&led_parallel_shadow[lane * strip_size], &frame[lane * strip_size], strip_size);
+            if (dirty > send) {
+                send = dirty;
+            }
+        }
+    }
+    else {
+        memcpy(led_parallel_shadow, frame, strip_size * led_parallel_lanes * sizeof(uint32_t));
+        led_parallel_shadowed = true;
+    }
+    if (send == 0) {
+        return false;
+    }
+
+    // Only the prefix being sent is transposed, into the planes that are
+    // not on the wire, before waiting for the last frame.
+    uint32_t *planes = led_parallel_planes[led_parallel_back];
+    size_t words = send * LED_TRANSPOSE_BITS;
+    if (led_parallel_kernel != NULL) {
+        led_parallel_kernel(planes, frame, strip_size, send);
+    }
+    else {
+        led_transpose_any(planes, frame, led_parallel_lanes, strip_size, send);
+    }
+    if (led_parallel_dma) {
+        led_dma_start(planes, words);
+        led_parallel_back ^= 1u;
+    }
+    else {
+        for (size_t idx = 0; idx < words; idx++) {
+            led_stats_put_blocking(led_parallel_pio, led_parallel_sm, planes[idx]);
+        }
+    }
+    return true;
+}
+
+/* End. */
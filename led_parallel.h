@@ -0,0 +1,62 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Parallel output to several LED strings with the ws2812_parallel program.
+ */
+
+#ifndef LED_PARALLEL_H
+#define LED_PARALLEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hardware/pio.h"
+
+/**
+ * @brief The most strings one state machine can drive.
+ */
+#define LED_PARALLEL_MAX_LANES (32)
+
+/**
+ * @brief Allocate the bit-plane buffers for parallel output.
+ * @details The state machine must already be running ws2812_parallel with
+ * "lanes" consecutive pins. Frames are sent with led_dma_start() when
+ * use_dma is true, from two plane buffers so one can be filled while the
+ * other is on the wire, otherwise with blocking PIO writes from one. With DMA the word
+ * time used to hold the latch is set to one bit at 800kHz, so call
+ * led_dma_set_word_us() afterwards for any other timing.
+ * 
+ * @param pio PIO handle.
+ * @param sm State machine identifier.
+ * @param lanes Number of strings (1 to LED_PARALLEL_MAX_LANES).
+ * @param strip_size Number of pixels in each string.
+ * @param use_dma True if led_dma_init() succeeded for this state machine.
+ * @return true Ready to send.
+ * @return false Bad lane count or allocation failed.
+ */
+bool led_parallel_init(PIO pio, uint sm, uint lanes, size_t strip_size, bool use_dma);
+
+/**
+ * @brief Wait for the current frame and free the bit-plane buffers.
+ */
+void led_parallel_deinit(void);
+
+/**
+ * @brief Transpose a frame and start sending it to all strings.
+ * @details Only the pixels up to the furthest change along any string
+ * since the last frame are transposed and sent, and an unchanged frame is
+ * not sent at all. With DMA the frame is transposed while the previous one
+ * is still on the wire, then waits for it. The frame may be rewritten as
+ * soon as this returns. Matches led_frames_writer_t.
+ * 
+ * @param frame The strings laid end to end, strip_size pixels each.
+ * @param frame_size Pixels in the frame (lanes x strip_size).
+ * @return true The frame was sent.
+ * @return false The frame was unchanged and skipped.
+ */
+bool led_parallel_write(const uint32_t *frame, size_t frame_size);
+
+#endif // LED_PARALLEL_H
+
+/* End. */
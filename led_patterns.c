@@ -0,0 +1,557 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Resumable LED patterns.
+ */
+
+#include <string.h>
+
+#include "led_anim.h"
+#include "led_bufops.h"
+#include "led_palette.h"
+#include "led_patterns.h"
+#include "led_wire.h"
+
+#define STEP_THREE_RAMP_MS (3000)   // Time to ramp each channel up.
+
+/**
+ * @brief Find where in the rise and fall a channel value sits.
+ * @details A value above half way starts on the way down, any other on the
+ * way up, so the channels move apart from the start.
+ * 
+ * @param value Channel value.
+ * @return uint32_t Phase (Q16).
+ */
+static uint32_t fade_three_phase(uint8_t value) {
+    uint32_t rise = ((uint32_t) value * (LED_ANIM_ONE / 2u)) / 255u;
+    return (value > 127) ? LED_ANIM_ONE - rise : rise;
+}
+
+/**
+ * @brief Get a channel value of the cross fade.
+ * 
+ * @param state Pattern state.
+ * @param channel Channel, 0 (red) to 2 (blue).
+ * @param phase Phase of the cycle at the frame time (Q16).
+ * @return uint8_t The channel value.
+ */
+static uint8_t fade_three_level(const led_pattern_state_t *state, int channel, uint32_t phase) {
+    uint32_t level = led_anim_triangle(state->fade.phase[channel] + phase);
+    if (state->fade.eased) {
+        level = led_anim_ease(level);
+    }
+    return led_anim_u8(level);
+}
+
+/**
+ * @brief Start a 3 channel cross fade (red, green and blue).
+ * 
+ * @param state Pattern state.
+ * @param params A led_fade_params_t.
+ */
+static void fade_three_init(led_pattern_state_t *state, const void *params) {
+    const led_fade_params_t *fade = params;
+    state->fade.red = fade->red;
+    state->fade.grn = fade->grn;
+    state->fade.blu = fade->blu;
+    state->fade.phase[0] = fade_three_phase(fade->red);
+    state->fade.phase[1] = fade_three_phase(fade->grn);
+    state->fade.phase[2] = fade_three_phase(fade->blu);
+    state->fade.period_ms = fade->period_ms;
+    state->fade.eased = fade->eased;
+    state->fade.drawn = false;
+}
+
+/**
+ * @brief Render a tile of the 3 channel cross fade.
+ * 
+ * @param state Pattern state, up to date.
+ * @param tile Filled with the pixels.
+ * @param first Index of the first pixel.
+ * @param count Pixels in the tile.
+ * @param t Frame time.
+ */
+static void fade_three_tile(const void *state, uint32_t *tile, size_t first, size_t count, uint32_t t) {
+    const led_pattern_state_t *fade = state;
+
+    // Draw the current RGB values, dimmed by the gamma table as they are sent.
+    uint32_t clrs[3] = {
+        rgb_u32(fade->fade.red, 0, 0),
+        rgb_u32(0, fade->fade.grn, 0),
+        rgb_u32(0, 0, fade->fade.blu)
+    };
+    for (size_t idx = 0; idx < count; idx++) {
+        tile[idx] = clrs[(first + idx) % 3];
+    }
+}
+
+/**
+ * @brief Render a frame of the 3 channel cross fade.
+ * @details Each channel rises and falls over the period, from where it
+ * started, so the values follow from the frame time alone.
+ * 
+ * @param state Pattern state.
+ * @param frame The frame to render, or NULL to only update the state.
+ * @param frame_size The number of pixels in the frame.
+ * @param t Frame time.
+ */
+static void fade_three_step(led_pattern_state_t *state, uint32_t *frame, size_t frame_size, uint32_t t) {
+    uint32_t phase = led_anim_phase(t, state->fade.period_ms);
+    state->fade.red = fade_three_level(state, 0, phase);
+    state->fade.grn = fade_three_level(state, 1, phase);
+    state->fade.blu = fade_three_level(state, 2, phase);
+    if (frame != NULL) {
+        fade_three_tile(state, frame, 0, frame_size, t);
+    }
+}
+
+/**
+ * @brief Generate a pixel of the 3 channel cross fade.
+ * 
+ * @param state Pattern state, up to date.
+ * @param index Pixel index.
+ * @param t Frame time.
+ * @return uint32_t The pixel.
+ */
+static uint32_t fade_three_pixel(const void *state, size_t index, uint32_t t) {
+    const led_pattern_state_t *fade = state;
+    switch (index % 3) {
+        default:
+        case 0:
+            return rgb_u32(fade->fade.red, 0, 0);
+        case 1:
+            return rgb_u32(0, fade->fade.grn, 0);
+        case 2:
+            return rgb_u32(0, 0, fade->fade.blu);
+    }
+}
+
+/**
+ * @brief Draw the 3 channel cross fade in palette indices.
+ * @details Each pixel keeps its channel's entry, only the palette changes.
+ * 
+ * @param state Pattern state, up to date.
+ * @param frame The index frame.
+ * @param frame_size The number of pixels in the frame.
+ * @param t Frame time.
+ */
+static void fade_three_indexed(led_pattern_state_t *state, uint8_t *frame, size_t frame_size, uint32_t t) {
+    if (state->fade.drawn == false) {
+        for (size_t idx = 0; idx < frame_size; idx++) {
+            frame[idx] = (uint8_t) (idx % 3);
+        }
+        state->fade.drawn = true;
+    }
+    led_palette_set(0, rgb_u32(state->fade.red, 0, 0));
+    led_palette_set(1, rgb_u32(0, state->fade.grn, 0));
+    led_palette_set(2, rgb_u32(0, 0, state->fade.blu));
+}
+
+/**
+ * @brief Start ramping each channel up in turn.
+ * 
+ * @param state Pattern state.
+ * @param params Unused.
+ */
+static void step_three_init(led_pattern_state_t *state, const void *params) {
+    state->ramp.index = 0;
+    state->ramp.value = 0;
+    state->ramp.drawn = false;
+}
+
+/**
+ * @brief Generate a pixel of the channel ramp.
+ * 
+ * @param state Pattern state, up to date.
+ * @param index Pixel index.
+ * @param t Frame time.
+ * @return uint32_t The pixel, the same along the whole string.
+ */
+static uint32_t step_three_pixel(const void *state, size_t index, uint32_t t) {
+    const led_pattern_state_t *ramp = state;
+    uint8_t clr_value = ramp->ramp.value;
+    switch (ramp->ramp.index) {
+        default:
+        case 0:
+            return rgb_u32(clr_value, 0, 0);
+        case 1:
+            return rgb_u32(0, clr_value, 0);
+        case 2:
+            return rgb_u32(0,0, clr_value);
+    }
+}
+
+/**
+ * @brief Render a tile of the channel ramp.
+ * 
+ * @param state Pattern state, up to date.
+ * @param tile Filled with the pixels.
+ * @param first Index of the first pixel.
+ * @param count Pixels in the tile.
+ * @param t Frame time.
+ */
+static void step_three_tile(const void *state, uint32_t *tile, size_t first, size_t count, uint32_t t) {
+    led_array_set(tile, count, step_three_pixel(state, first, t));
+}
+
+/**
+ * @brief Draw the channel ramp in palette indices.
+ * 
+ * @param state Pattern state, up to date.
+ * @param frame The index frame.
+ * @param frame_size The number of pixels in the frame.
+ * @param t Frame time.
+ */
+static void step_three_indexed(led_pattern_state_t *state, uint8_t *frame, size_t frame_size, uint32_t t) {
+    if (state->ramp.drawn == false) {
+        memset(frame, 0, frame_size);
+        state->ramp.drawn = true;
+    }
+    led_palette_set(0, step_three_pixel(state, 0, t));
+}
+
+/**
+ * @brief Render a frame of the channel ramp.
+ * @details Each channel ramps up over STEP_THREE_RAMP_MS in turn.
+ * 
+ * @param state Pattern state.
+ * @param frame The frame to render, or NULL to only update the state.
+ * @param frame_size The number of pixels in the frame.
+ * @param t Frame time.
+ */
+static void step_three_step(led_pattern_state_t *state, uint32_t *frame, size_t frame_size, uint32_t t) {
+    state->ramp.index = (int) ((t / STEP_THREE_RAMP_MS) % 3u);
+    state->ramp.value = led_anim_u8(led_anim_phase(t, STEP_THREE_RAMP_MS));
+    if (frame != NULL) {
+        led_bufops_fill(frame, step_three_pixel(state, 0, t), frame_size);
+    }
+}
+
+/**
+ * @brief Start three colours walking along the string of LEDs.
+ * 
+ * @param state Pattern state.
+ * @param params A led_walk_params_t.
+ */
+static void walk_three_init(led_pattern_state_t *state, const void *params) {
+    const led_walk_params_t *walk = params;
+    state->walk.step_ms = (walk->step_ms > 0) ? walk->step_ms : 1;
+    state->walk.drawn = false;
+}
+
+/**
+ * @brief Get how far the three colours have walked, modulo 3.
+ * 
+ * @param state Pattern state.
+ * @param t Frame time.
+ * @return uint32_t Steps taken, 0 to 2.
+ */
+static uint32_t walk_three_offset(const led_pattern_state_t *state, uint32_t t) {
+    return (t / state->walk.step_ms) % 3u;
+}
+
+/**
+ * @brief Render a tile of three colours walking along the string of LEDs.
+ * @details Each step moves the colours along by one LED.
+ * 
+ * @param state Pattern state.
+ * @param tile Filled with the pixels.
+ * @param first Index of the first pixel.
+ * @param count Pixels in the tile.
+ * @param t Frame time.
+ */
+static void walk_three_tile(const void *state, uint32_t *tile, size_t first, size_t count, uint32_t t) {
+
+    // Establish the colours, each step moves them along by one LED.
+    const uint32_t clrs[3] = {
+        rgb_u32(255, 0, 0),
+        rgb_u32(0, 255, 0),
+        rgb_u32(0, 0, 255)
+    };
+    uint32_t step = walk_three_offset(state, t);
+    for (size_t i = 0; i < count; i++) {
+        tile[i] = clrs[(first + i + step) % 3];
+    }
+}
+
+/**
+ * @brief Render a frame of three colours walking along the string of LEDs.
+ * @details The position follows from the frame time, so nothing changes
+ * in the state.
+ * 
+ * @param state Pattern state.
+ * @param frame The frame to render, or NULL to only update the state.
+ * @param frame_size The number of pixels in the frame.
+ * @param t Frame time.
+ */
+static void walk_three_step(led_pattern_state_t *state, uint32_t *frame, size_t frame_size, uint32_t t) {
+    if (frame != NULL) {
+        walk_three_tile(state, frame, 0, frame_size, t);
+    }
+}
+
+/**
+ * @brief Generate a pixel of three colours walking along the string.
+ * 
+ * @param state Pattern state.
+ * @param index Pixel index.
+ * @param t Frame time.
+ * @return uint32_t The pixel.
+ */
+static uint32_t walk_three_pixel(const void *state, size_t index, uint32_t t) {
+    switch ((index + walk_three_offset(state, t)) % 3) {
+        default:
+        case 0:
+            return rgb_u32(255, 0, 0);
+        case 1:
+            return rgb_u32(0, 255, 0);
+        case 2:
+            return rgb_u32(0, 0, 255);
+    }
+}
+
+/**
+ * @brief Draw three colours walking along the string in palette indices.
+ * @details The indices stay put and the colours rotate through the palette.
+ * 
+ * @param state Pattern state.
+ * @param frame The index frame.
+ * @param frame_size The number of pixels in the frame.
+ * @param t Frame time.
+ */
+static void walk_three_indexed(led_pattern_state_t *state, uint8_t *frame, size_t frame_size, uint32_t t) {
+    if (state->walk.drawn == false) {
+        for (size_t idx = 0; idx < frame_size; idx++) {
+            frame[idx] = (uint8_t) (idx % 3);
+        }
+        state->walk.drawn = true;
+    }
+    for (size_t idx = 0; idx < 3; idx++) {
+        led_palette_set((uint8_t) idx, walk_three_pixel(state, idx, t));
+    }
+}
+
+/**
+ * @brief Draw three colours walking along the string in a scrolled frame.
+ * @details The colours are drawn once and the frame is sent from an offset
+ * that moves on by one each step. The first three pixels are sent last
+ * when the offset wraps, so they are redrawn each frame to follow on from
+ * the end of the string rather than the start.
+ * 
+ * @param state Pattern state.
+ * @param frame The wire format frame.
+ * @param frame_size The number of pixels in the frame.
+ * @param t Frame time.
+ * @return size_t Offset to send the frame from.
+ */
+static size_t walk_three_scroll(led_pattern_state_t *state, uint32_t *frame, size_t frame_size, uint32_t t) {
+    if (frame_size < 3) {
+        for (size_t idx = 0; idx < frame_size; idx++) {
+            frame[idx] = led_wire_from_pixel(walk_three_pixel(state, idx, t));
+        }
+        return 0;
+    }
+    if (state->walk.drawn == false) {
+        for (size_t idx = 3; idx < frame_size; idx++) {
+            frame[idx] = led_wire_from_pixel(walk_three_pixel(state, idx, 0));
+        }
+        state->walk.drawn = true;
+    }
+    size_t offset = walk_three_offset(state, t);
+    for (size_t idx = 0; idx < 3; idx++) {
+        frame[idx] = led_wire_from_pixel(walk_three_pixel(state, (idx < offset) ? frame_size + idx : idx, 0));
+    }
+    return offset;
+}
+
+/**
+ * @brief Start a single LED chasing back and forth along the string.
+ * 
+ * @param state Pattern state.
+ * @param params A led_chase_params_t.
+ */
+static void chase_colour_init(led_pattern_state_t *state, const void *params) {
+
+    // Start the run with red, then green then blue.
+    const led_chase_params_t *chase = params;
+    state->chase.pos = 0;
+    state->chase.id = 'r';
+    state->chase.bg_on = chase->bg_on;
+    state->chase.step_ms = (chase->step_ms > 0) ? chase->step_ms : 1;
+    state->chase.drawn_pos = -1;
+    state->chase.drawn_id = 0;
+}
+
+/**
+ * @brief Create a colour code from the colour id.
+ * @details Linear values, the background is just above black after gamma
+ * correction.
+ * 
+ * @param state Pattern state.
+ * @param clr_fg Set to the colour of the lit LED.
+ * @param clr_bg Set to the colour of the others.
+ */
+static void chase_colour_colours(const led_pattern_state_t *state, uint32_t *clr_fg, uint32_t *clr_bg) {
+    bool bg_on = state->chase.bg_on;
+    if (state->chase.id == 'r') {
+        *clr_fg = 0xc00000u;
+        *clr_bg = bg_on ? 0x006050u : 0;
+    }
+    else if (state->chase.id == 'g') {
+        *clr_fg = 0x00c000u;
+        *clr_bg = bg_on ? 0x500060u : 0;
+    }
+    else {
+        *clr_fg = 0x0000c0u;
+        *clr_bg = bg_on ? 0x605000u : 0;
+    }
+}
+
+/**
+ * @brief Render a tile of the colour chaser.
+ * 
+ * @param state Pattern state, up to date.
+ * @param tile Filled with the pixels.
+ * @param first Index of the first pixel.
+ * @param count Pixels in the tile.
+ * @param t Frame time.
+ */
+static void chase_colour_tile(const void *state, uint32_t *tile, size_t first, size_t count, uint32_t t) {
+    const led_pattern_state_t *chase = state;
+    uint32_t clr_fg, clr_bg;
+    chase_colour_colours(chase, &clr_fg, &clr_bg);
+
+    // Clear the tile, setting the indexed colour only if it falls in it.
+    led_array_set(tile, count, clr_bg);
+    size_t pos = (size_t) chase->chase.pos;
+    if (pos >= first && pos < first + count) {
+        tile[pos - first] = clr_fg;
+    }
+}
+
+/**
+ * @brief Render a frame of the colour chaser.
+ * @details A run out to the end of the string and back takes two steps for
+ * each LED, the end LEDs being lit for two steps, and the colour changes
+ * at the start of each run. The position follows from the frame time.
+ * 
+ * @param state Pattern state.
+ * @param frame The frame to render, or NULL to only update the state.
+ * @param frame_size The number of pixels in the frame.
+ * @param t Frame time.
+ */
+static void chase_colour_step(led_pattern_state_t *state, uint32_t *frame, size_t frame_size, uint32_t t) {
+    static const uint8_t ids[3] = { 'r', 'g', 'b' };
+    uint32_t steps = t / state->chase.step_ms;
+    uint32_t run = 2u * (uint32_t) frame_size;
+    if (run > 0) {
+        uint32_t at = steps % run;
+        state->chase.pos = (int) ((at < frame_size) ? at : run - 1u - at);
+        state->chase.id = ids[(steps / run) % 3u];
+    }
+
+    // Clear the frame and set the lit LED behind it, both on the DMA.
+    if (frame != NULL) {
+        uint32_t clr_fg, clr_bg;
+        chase_colour_colours(state, &clr_fg, &clr_bg);
+        led_bufops_fill(frame, clr_bg, frame_size);
+        led_bufops_fill(frame + state->chase.pos, clr_fg, 1);
+    }
+}
+
+/**
+ * @brief Generate a pixel of the colour chaser.
+ * 
+ * @param state Pattern state, up to date.
+ * @param index Pixel index.
+ * @param t Frame time.
+ * @return uint32_t The pixel.
+ */
+static uint32_t chase_colour_pixel(const void *state, size_t index, uint32_t t) {
+    const led_pattern_state_t *chase = state;
+    uint32_t clr_fg, clr_bg;
+    chase_colour_colours(chase, &clr_fg, &clr_bg);
+    return (index == (size_t) chase->chase.pos) ? clr_fg : clr_bg;
+}
+
+/**
+ * @brief Draw the colour chaser in palette indices.
+ * @details The background is entry 0 and the lit LED entry 1, so each frame
+ * moves one index and sets the two colours.
+ * 
+ * @param state Pattern state, up to date.
+ * @param frame The index frame.
+ * @param frame_size The number of pixels in the frame.
+ * @param t Frame time.
+ */
+static void chase_colour_indexed(led_pattern_state_t *state, uint8_t *frame, size_t frame_size, uint32_t t) {
+    if (state->chase.drawn_pos < 0) {
+        memset(frame, 0, frame_size);
+    }
+    else {
+        frame[state->chase.drawn_pos] = 0;
+    }
+    frame[state->chase.pos] = 1;
+    state->chase.drawn_pos = state->chase.pos;
+
+    uint32_t clr_fg, clr_bg;
+    chase_colour_colours(state, &clr_fg, &clr_bg);
+    led_palette_set(0, clr_bg);
+    led_palette_set(1, clr_fg);
+}
+
+/**
+ * @brief Draw the colour chaser in a scrolled frame.
+ * @details The lit LED is drawn first in the frame and the frame is sent
+ * from the offset that puts it at its position, so it is only redrawn when
+ * the colours change at the end of each run.
+ * 
+ * @param state Pattern state, up to date.
+ * @param frame The wire format frame.
+ * @param frame_size The number of pixels in the frame.
+ * @param t Frame time.
+ * @return size_t Offset to send the frame from.
+ */
+static size_t chase_colour_scroll(led_pattern_state_t *state, uint32_t *frame, size_t frame_size, uint32_t t) {
+    if (frame_size == 0) {
+        return 0;
+    }
+    if (state->chase.drawn_id != state->chase.id) {
+        uint32_t clr_fg, clr_bg;
+        chase_colour_colours(state, &clr_fg, &clr_bg);
+        led_bufops_fill(frame, led_wire_from_pixel(clr_bg), frame_size);
+        led_bufops_fill(frame, led_wire_from_pixel(clr_fg), 1);
+        state->chase.drawn_id = state->chase.id;
+    }
+    return (frame_size - (size_t) state->chase.pos) % frame_size;
+}
+
+// Parameter blocks.
+static const led_fade_params_t  fade_slow = { 255, 0, 127, 6000, false };
+static const led_fade_params_t  fade_quick = { 255, 0, 127, 3000, true };
+static const led_walk_params_t  walk_quick = { 100 };
+static const led_walk_params_t  walk_slow = { 200 };
+static const led_chase_params_t chase_black = { false, 30 };
+static const led_chase_params_t chase_background = { true, 30 };
+
+/**
+ * @brief The modes, in the order the button steps through them.
+ * @details Add a mode by adding an entry, the main loop needs no changes.
+ * The slow fade takes 3 seconds for each rise or fall of a channel and the
+ * quick pulse half that, eased at each end, and the channel ramp raises
+ * each channel in turn over the same 3 seconds. The frame rate only sets
+ * how smoothly each mode moves. The fades and the triple chaser repeat
+ * every 3 pixels, and the whole string shows one colour in the ramp.
+ */
+const led_pattern_t led_patterns[] = {
+    { "triple chaser",              walk_three_init,    walk_three_step,    walk_three_pixel,   walk_three_tile,    walk_three_indexed,     walk_three_scroll,   &walk_quick,        3,  10, 300 },
+    { "slow fade",                  fade_three_init,    fade_three_step,    fade_three_pixel,   fade_three_tile,    fade_three_indexed,     NULL,                &fade_slow,         3,  85, 300 },
+    { "slow triple chaser",         walk_three_init,    walk_three_step,    walk_three_pixel,   walk_three_tile,    walk_three_indexed,     walk_three_scroll,   &walk_slow,         3,  5,  300 },
+    { "quick pulse",                fade_three_init,    fade_three_step,    fade_three_pixel,   fade_three_tile,    fade_three_indexed,     NULL,                &fade_quick,        3,  85, 300 },
+    { "colour chaser",              chase_colour_init,  chase_colour_step,  chase_colour_pixel, chase_colour_tile,  chase_colour_indexed,   chase_colour_scroll, &chase_black,       0,  33, 80 },
+    { "colour chaser on colour",    chase_colour_init,  chase_colour_step,  chase_colour_pixel, chase_colour_tile,  chase_colour_indexed,   chase_colour_scroll, &chase_background,  0,  33, 80 },
+    { "channel ramp",               step_three_init,    step_three_step,    step_three_pixel,   step_three_tile,    step_three_indexed,     NULL,                NULL,               1,  85, 80 },
+};
+const size_t led_patterns_count = sizeof(led_patterns) / sizeof(led_patterns[0]);
+
+/* End. */
@@ -0,0 +1,163 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Resumable LED patterns.
+ *
+ * A pattern keeps everything it needs between frames in a state object.
+ * init() sets the state up from the parameter block, and each call to
+ * step() renders one whole frame and returns. The frame time t is the
+ * animation clock (see led_anim.h), in ms from the start of the pattern to
+ * when the frame will be shown. Patterns work out their state from t rather
+ * than stepping it once per frame, so late or skipped frames do not slow
+ * the animation and the frame rate only sets how smooth it is. Nothing
+ * blocks, so the caller decides when frames are rendered and can interleave
+ * other work between them. Large fills of the frame are left running on the
+ * DMA (see led_bufops.h), and the frame is complete once led_bufops_wait()
+ * returns, which the frame pipeline calls before reading it.
+ *
+ * A pattern may also generate its pixels one at a time with pixel(), so it
+ * can be streamed without a frame buffer, or a tile of consecutive pixels
+ * at a time with tile(). The caller first brings the state up to t with
+ * step(state, NULL, frame_size, t), then asks for each pixel or tile in
+ * order. step() renders its frames as a single tile.
+ *
+ * indexed() draws into a frame of led_palette.h indices that keeps its
+ * contents between frames, setting the palette entries it uses. Patterns
+ * write the indices once and then change only those that move, so most
+ * frames cost a few palette entries rather than a pass over every pixel.
+ * As with pixel(), the state is first brought up to t with step().
+ *
+ * scroll() draws into a frame of wire format words (see led_wire.h) that
+ * keeps its contents between frames, and returns the offset to send it
+ * from (see led_scroll.h). Patterns that only move along the string draw
+ * the frame once and then return a new offset, changing at most a few
+ * words. The state is first brought up to t with step().
+ *
+ * A pattern whose frames repeat every few pixels gives the length as its
+ * period. The caller can then render only the first period with tile() and
+ * send it repeated along the string (see led_frames_repeat()).
+ */
+
+#ifndef LED_PATTERNS_H
+#define LED_PATTERNS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Parameters of the three channel cross fade.
+ */
+typedef struct led_fade_params_s {
+    uint8_t red;                        // Initial red channel value.
+    uint8_t grn;                        // Initial green channel value.
+    uint8_t blu;                        // Initial blue channel value.
+    uint16_t period_ms;                 // Time for each channel to rise and fall (in ms).
+    bool eased;                         // Ease in and out of each end.
+} led_fade_params_t;
+
+/**
+ * @brief Parameters of the triple chaser.
+ */
+typedef struct led_walk_params_s {
+    uint16_t step_ms;                   // Time between steps along the string (in ms).
+} led_walk_params_t;
+
+/**
+ * @brief Parameters of the colour chaser.
+ */
+typedef struct led_chase_params_s {
+    bool bg_on;                         // True for colour background, false for black.
+    uint16_t step_ms;                   // Time the lit LED stays at each position (in ms).
+} led_chase_params_t;
+
+/**
+ * @brief State of any pattern, large enough for each of them.
+ */
+typedef union led_pattern_state_u {
+    struct {
+        uint8_t red, grn, blu;          // Current channel values.
+        uint32_t phase[3];              // Phase of each channel at time 0 (Q16).
+        uint16_t period_ms;             // Time for each channel to rise and fall.
+        bool eased;                     // Ease in and out of each end.
+        bool drawn;                     // The index frame has been drawn.
+    } fade;
+    struct {
+        int index;                      // Channel being ramped.
+        uint8_t value;                  // Channel value.
+        bool drawn;                     // The index frame has been drawn.
+    } ramp;
+    struct {
+        uint16_t step_ms;               // Time between steps.
+        bool drawn;                     // The index frame has been drawn.
+    } walk;
+    struct {
+        int pos;                        // Position of the lit LED.
+        uint8_t id;                     // Colour, 'r', 'g' or 'b'.
+        bool bg_on;                     // Colour background.
+        uint16_t step_ms;               // Time at each position.
+        int drawn_pos;                  // Lit LED in the index frame, -1 before drawing.
+        uint8_t drawn_id;               // Colour of the scrolled frame, 0 before drawing.
+    } chase;
+} led_pattern_state_t;
+
+/**
+ * @brief Pattern (mode) descriptor, one entry in the led_patterns[] table.
+ * @details The cost is an estimate of the render time per pixel on the
+ * RP2040, used to start rendering each frame early enough to present it on
+ * time and to warn when a pattern cannot keep its rate.
+ */
+typedef struct led_pattern_s {
+    const char *name;                   // Shown when the mode starts.
+    void (*init)(led_pattern_state_t *state, const void *params);
+    void (*step)(led_pattern_state_t *state, uint32_t *frame, size_t frame_size, uint32_t t);
+    uint32_t (*pixel)(const void *state, size_t index, uint32_t t);
+    void (*tile)(const void *state, uint32_t *tile, size_t first, size_t count, uint32_t t);
+    void (*indexed)(led_pattern_state_t *state, uint8_t *frame, size_t frame_size, uint32_t t);
+    size_t (*scroll)(led_pattern_state_t *state, uint32_t *frame, size_t frame_size, uint32_t t);
+    const void *params;                 // Parameter block passed to init.
+    uint16_t period;                    // Pixels after which every frame repeats, 0 if it does not.
+    uint16_t fps;                       // Target frame rate.
+    uint16_t cost_ns;                   // Estimated render time per pixel (in ns).
+} led_pattern_t;
+
+/**
+ * @brief The modes, in the order the button steps through them.
+ */
+extern const led_pattern_t led_patterns[];
+
+/**
+ * @brief Number of entries in led_patterns[].
+ */
+extern const size_t led_patterns_count;
+
+/**
+ * @brief Format a RGBw value to a pixel.
+ * @details The ws2812b has GRB encoded LEDS, check for the encoding of your
+ * specific LED type.
+ * 
+ * @param r Red value.
+ * @param g Green value.
+ * @param b Blue value.
+ * @return uint32_t Formatted RGB value.
+ */
+static inline uint32_t rgb_u32(uint8_t r, uint8_t g, uint8_t b) {
+    return ((uint32_t) (g) << 8) | ((uint32_t) (r) << 16) | (uint32_t) (b);
+}
+
+/**
+ * @brief Set the led array to given colour.
+ * 
+ * @param array A pointer to an array of uint32_t values.
+ * @param array_size The number of elements in the array.
+ * @param colour RGB colour.
+ */
+static inline void led_array_set(uint32_t *array, size_t array_size, uint32_t colour) {
+    for (size_t idx = 0; idx < array_size; idx++) {
+        *array++ = colour;
+    }
+}
+
+#endif // LED_PATTERNS_H
+
+/* End. */
@@ -0,0 +1,127 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Fixed deadline frame scheduler for the LED patterns.
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "led_sched.h"
+#include "led_stats.h"
+
+// Operating data.
+static absolute_time_t          led_sched_base;                 // Wake up time of frame 0.
+static uint32_t                 led_sched_fps = 1;              // Target frame rate.
+static uint32_t                 led_sched_frame = 0;            // Frame of the armed deadline.
+static alarm_id_t               led_sched_alarm = 0;            // Armed alarm, 0 for none.
+static volatile bool            led_sched_due = false;          // The armed deadline has passed.
+static volatile bool            led_sched_woken = false;        // Wait cut short by an event.
+static led_sched_stats_t        led_sched_stats;                // Counters for this run.
+
+/**
+ * @brief Get the deadline of a frame.
+ * @details Computed from the start so rounding does not accumulate.
+ * 
+ * @param frame Frame number.
+ * @return absolute_time_t When the frame is due.
+ */
+static absolute_time_t led_sched_deadline(uint32_t frame) {
+    return delayed_by_us(led_sched_base, ((uint64_t) frame * 1000000u) / led_sched_fps);
+}
+
+/**
+ * @brief Alarm fired at the frame deadline.
+ * 
+ * @param id Alarm identifier.
+ * @param user_data Unused.
+ * @return int64_t 0, do not reschedule.
+ */
+static int64_t led_sched_alarm_cb(alarm_id_t id, void *user_data) {
+    led_sched_alarm = 0;
+    led_sched_due = true;
+    __sev();
+    return 0;
+}
+
+/**
+ * @brief Arm the alarm for the current frame, firing now if it has passed.
+ */
+static void led_sched_arm(void) {
+    led_sched_due = false;
+    alarm_id_t id = add_alarm_at(led_sched_deadline(led_sched_frame), led_sched_alarm_cb, NULL, true);
+    if (id > 0) {
+        led_sched_alarm = id;
+    }
+
+    // No free alarm, poll the deadline instead of hanging.
+    else if (id < 0) {
+        led_sched_due = true;
+    }
+}
+
+void led_sched_start(uint32_t fps, uint32_t lead_us) {
+    led_sched_stop();
+    led_sched_fps = (fps > 0) ? fps : 1;
+
+    // Wake each frame early by the render time, no more than a period.
+    uint64_t period_us = 1000000u / led_sched_fps;
+    uint64_t now_us = to_us_since_boot(get_absolute_time());
+    if (lead_us > period_us) {
+        lead_us = (uint32_t) period_us;
+    }
+    if (lead_us > now_us) {
+        lead_us = (uint32_t) now_us;
+    }
+    led_sched_base = from_us_since_boot(now_us - lead_us);
+    led_sched_frame = 1;
+    led_sched_stats = (led_sched_stats_t) { .fps = led_sched_fps, .lead_us = lead_us };
+    led_sched_woken = false;
+    led_sched_arm();
+}
+
+void led_sched_stop(void) {
+    if (led_sched_alarm > 0) {
+        cancel_alarm(led_sched_alarm);
+        led_sched_alarm = 0;
+    }
+    led_sched_due = false;
+}
+
+uint32_t led_sched_wait(void) {
+    while (led_sched_due == false) {
+        if (led_sched_woken) {
+            led_sched_woken = false;
+            return 0;
+        }
+        __wfe();
+    }
+    led_sched_woken = false;
+
+    // Find the first deadline still to come, any skipped were missed.
+    absolute_time_t now = get_absolute_time();
+    int64_t late_us = absolute_time_diff_us(led_sched_deadline(led_sched_frame), now);
+    if (late_us > (int64_t) led_sched_stats.late_max_us) {
+        led_sched_stats.late_max_us = (uint32_t) late_us;
+    }
+    led_stats_add(LED_STATS_LATE, (late_us > 0) ? (uint32_t) late_us : 0);
+    uint32_t ticks = 0;
+    do {
+        led_sched_frame++;
+        ticks++;
+    } while (absolute_time_diff_us(now, led_sched_deadline(led_sched_frame)) <= 0);
+    led_sched_stats.frames++;
+    led_sched_stats.missed += ticks - 1;
+    led_sched_arm();
+    return ticks;
+}
+
+void led_sched_wake(void) {
+    led_sched_woken = true;
+    __sev();
+}
+
+void led_sched_get_stats(led_sched_stats_t *stats) {
+    *stats = led_sched_stats;
+}
+
+/* End. */
@@ -0,0 +1,71 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Fixed deadline frame scheduler for the LED patterns.
+ *
+ * Frame n of a pattern is due at start + n / fps, computed from the start
+ * time rather than the previous frame, so the period does not drift with
+ * render or transmit time. A hardware alarm is armed for each deadline and
+ * led_sched_wait() sleeps until it fires. If rendering overruns, the
+ * deadlines that passed are counted as missed and returned as extra ticks.
+ * The patterns take their time from led_anim.h, so animation speed stays
+ * the same either way. An input event can cut the wait short with
+ * led_sched_wake(), so a pattern reacts within a frame however slow its
+ * frame rate.
+ */
+
+#ifndef LED_SCHED_H
+#define LED_SCHED_H
+
+#include <stdint.h>
+
+/**
+ * @brief Scheduler counters, reset by led_sched_start().
+ */
+typedef struct led_sched_stats_s {
+    uint32_t fps;                       // Target frame rate.
+    uint32_t lead_us;                   // Render time allowed before each deadline.
+    uint32_t frames;                    // Deadlines met.
+    uint32_t missed;                    // Deadlines that passed without a frame.
+    uint32_t late_max_us;               // Latest wake up after a deadline.
+} led_sched_stats_t;
+
+/**
+ * @brief Start a new run of deadlines and arm the alarm for the first.
+ * @details The pattern is woken lead_us ahead of each deadline, so a frame
+ * that takes that long to render is presented on time.
+ * 
+ * @param fps Target frame rate, 1 or more.
+ * @param lead_us Estimated render time of a frame (in us).
+ */
+void led_sched_start(uint32_t fps, uint32_t lead_us);
+
+/**
+ * @brief Cancel the pending alarm.
+ */
+void led_sched_stop(void);
+
+/**
+ * @brief Wait for the next frame deadline, or a call to led_sched_wake().
+ * 
+ * @return uint32_t The number of frame periods that have elapsed, 1 unless
+ * deadlines were missed, or 0 if woken before the deadline.
+ */
+uint32_t led_sched_wait(void);
+
+/**
+ * @brief Wake led_sched_wait() before its deadline.
+ * @details Safe to call from an interrupt handler. The deadline stays armed.
+ */
+void led_sched_wake(void);
+
+/**
+ * @brief Get the counters for the current (or last) run.
+ * 
+ * @param stats Filled with the counters.
+ */
+void led_sched_get_stats(led_sched_stats_t *stats);
+
+#endif // LED_SCHED_H
+
+/* End. */
@@ -0,0 +1,69 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * A single frame scrolled along the string by sending it from an offset.
+ */
+
+#include <stdlib.h>
+
+#include "pico/stdlib.h"
+#include "led_bufops.h"
+#include "led_dma.h"
+#include "led_scroll.h"
+#include "led_stats.h"
+
+// Operating data.
+static PIO                      led_scroll_pio;                 // PIO running the ws2812 program.
+static uint                     led_scroll_sm;                  // State machine being fed.
+static bool                     led_scroll_dma = false;         // The frame is sent by DMA.
+static uint32_t                 *led_scroll_buf = NULL;         // The frame, in wire format.
+static size_t                   led_scroll_pixels = 0;          // Pixels in the frame.
+
+bool led_scroll_init(PIO pio, uint sm, size_t frame_size, bool use_dma) {
+    led_scroll_buf = calloc(sizeof(uint32_t), frame_size);
+    if (led_scroll_buf == NULL) {
+        return false;
+    }
+    led_scroll_pio = pio;
+    led_scroll_sm = sm;
+    led_scroll_dma = use_dma;
+    led_scroll_pixels = frame_size;
+    return true;
+}
+
+void led_scroll_deinit(void) {
+    if (led_scroll_dma) {
+        led_dma_wait();
+    }
+    free(led_scroll_buf);
+    led_scroll_buf = NULL;
+    led_scroll_pixels = 0;
+}
+
+uint32_t *led_scroll_frame(void) {
+    if (led_scroll_dma) {
+        led_dma_wait();
+    }
+    return led_scroll_buf;
+}
+
+void led_scroll_show(size_t offset) {
+    if (led_scroll_pixels == 0) {
+        return;
+    }
+    offset %= led_scroll_pixels;
+    led_bufops_wait();
+    if (led_scroll_dma) {
+        led_dma_start_rotated(led_scroll_buf, led_scroll_pixels, offset);
+    }
+    else {
+        for (size_t idx = offset; idx < led_scroll_pixels; idx++) {
+            led_stats_put_blocking(led_scroll_pio, led_scroll_sm, led_scroll_buf[idx]);
+        }
+        for (size_t idx = 0; idx < offset; idx++) {
+            led_stats_put_blocking(led_scroll_pio, led_scroll_sm, led_scroll_buf[idx]);
+        }
+    }
+}
+
+/* End. */
@@ -0,0 +1,59 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * A single frame scrolled along the string by sending it from an offset.
+ *
+ * The frame is held in wire format and sent starting at any pixel, wrapping
+ * round to the start. With DMA the end and then the start of the buffer are
+ * sent by two chained channels (see led_dma_start_rotated()), so a pattern
+ * that only moves along the string is drawn once and each frame costs a
+ * change of offset rather than a pass over every pixel.
+ */
+
+#ifndef LED_SCROLL_H
+#define LED_SCROLL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hardware/pio.h"
+
+/**
+ * @brief Allocate the frame.
+ * 
+ * @param pio PIO handle.
+ * @param sm State machine identifier, running the ws2812 program.
+ * @param frame_size Number of pixels in the frame.
+ * @param use_dma True to send by DMA (led_dma_init() has succeeded), false
+ * for blocking writes.
+ * @return true The frame is ready.
+ * @return false Out of memory.
+ */
+bool led_scroll_init(PIO pio, uint sm, size_t frame_size, bool use_dma);
+
+/**
+ * @brief Wait for the frame to be sent and release it.
+ */
+void led_scroll_deinit(void);
+
+/**
+ * @brief Get the frame, in wire format, to change it.
+ * @details Waits until the last frame has been sent. The contents are kept
+ * between frames.
+ * 
+ * @return uint32_t* The frame.
+ */
+uint32_t *led_scroll_frame(void);
+
+/**
+ * @brief Send the frame starting from an offset.
+ * @details Pixel i of the string gets frame[(offset + i) % frame_size].
+ * 
+ * @param offset Index of the pixel sent first.
+ */
+void led_scroll_show(size_t offset);
+
+#endif // LED_SCROLL_H
+
+/* End. */
@@ -0,0 +1,121 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Frame timing instrumentation for the transmit path.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "led_stats.h"
+
+// Operating data.
+static led_stats_measure_t      led_stats[LED_STATS_COUNT];     // The measures.
+static volatile uint32_t        led_stats_stall_us = 0;         // Time blocked, running total.
+static uint32_t                 led_stats_last_us = 0;          // When the last frame was presented.
+static bool                     led_stats_started = false;      // led_stats_last_us is set.
+static const char               *const led_stats_names[LED_STATS_COUNT] = {
+    "render", "wire", "blocked", "period", "late"
+};
+
+/**
+ * @brief Get the histogram bin of a sample.
+ *
+ * @param us The sample (in us).
+ * @return uint Bin, 0 to LED_STATS_BINS - 1.
+ */
+static uint led_stats_bin(uint32_t us) {
+    if (us == 0) {
+        return 0;
+    }
+    uint bin = 32u - (uint) __builtin_clz(us);
+    return (bin < LED_STATS_BINS) ? bin : LED_STATS_BINS - 1u;
+}
+
+void led_stats_reset(void) {
+    uint32_t save = save_and_disable_interrupts();
+    memset(led_stats, 0, sizeof(led_stats));
+    restore_interrupts(save);
+    led_stats_started = false;
+}
+
+void led_stats_add(led_stats_id_t id, uint32_t us) {
+    led_stats_measure_t *m = &led_stats[id];
+    if (m->count == 0 || us < m->min_us) {
+        m->min_us = us;
+    }
+    if (us > m->max_us) {
+        m->max_us = us;
+    }
+    m->count++;
+    m->sum_us += us;
+    m->bins[led_stats_bin(us)]++;
+}
+
+void led_stats_frame(void) {
+    uint32_t now = time_us_32();
+    if (led_stats_started) {
+        led_stats_add(LED_STATS_PERIOD, now - led_stats_last_us);
+    }
+    led_stats_last_us = now;
+    led_stats_started = true;
+}
+
+void led_stats_stall(uint32_t us) {
+    if (get_core_num() == 0) {
+        led_stats_stall_us += us;
+    }
+}
+
+uint32_t led_stats_stalled(void) {
+    return led_stats_stall_us;
+}
+
+void led_stats_get(led_stats_id_t id, led_stats_measure_t *measure) {
+    uint32_t save = save_and_disable_interrupts();
+    *measure = led_stats[id];
+    restore_interrupts(save);
+}
+
+void led_stats_dump(bool histograms) {
+    led_stats_measure_t m;
+
+    // The achieved rate is the mean of the frame intervals.
+    led_stats_get(LED_STATS_PERIOD, &m);
+    if (m.sum_us > 0) {
+        uint32_t fps10 = (uint32_t) (((uint64_t) m.count * 10000000u + m.sum_us / 2u) / m.sum_us);
+        printf("led stats: %lu frames at %lu.%lu fps\n", (unsigned long) m.count + 1u,
+            (unsigned long) (fps10 / 10u), (unsigned long) (fps10 % 10u));
+    }
+    for (int id = 0; id < LED_STATS_COUNT; id++) {
+        led_stats_get((led_stats_id_t) id, &m);
+        if (m.count == 0) {
+            printf("  %-8s no samples\n", led_stats_names[id]);
+            continue;
+        }
+        printf("  %-8s %lu x, min %lu avg %lu max %lu us\n", led_stats_names[id], (unsigned long) m.count,
+            (unsigned long) m.min_us, (unsigned long) (m.sum_us / m.count), (unsigned long) m.max_us);
+        if (histograms == false) {
+            continue;
+        }
+        for (uint bin = 0; bin < LED_STATS_BINS; bin++) {
+            if (m.bins[bin] == 0) {
+                continue;
+            }
+            if (bin == 0) {
+                printf("    %16s: %lu\n", "0 us", (unsigned long) m.bins[bin]);
+            }
+            else if (bin == LED_STATS_BINS - 1u) {
+                printf("    %10lu us up: %lu\n", (unsigned long) (1u << (bin - 1u)), (unsigned long) m.bins[bin]);
+            }
+            else {
+                printf("    %6lu-%6lu us: %lu\n", (unsigned long) (1u << (bin - 1u)),
+                    (unsigned long) ((1u << bin) - 1u), (unsigned long) m.bins[bin]);
+            }
+        }
+    }
+}
+
+/* End. */
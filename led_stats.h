@@ -0,0 +1,134 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Frame timing instrumentation for the transmit path.
+ *
+ * Each frame adds one sample, in us from the microsecond timer, to each of
+ * a few measures: the time to render it, the time it spent on the wire,
+ * the time the renderer was blocked on a full PIO FIFO or waiting for the
+ * DMA, the interval since the frame before (the achieved frame rate) and
+ * how late the scheduler woke for it. Every measure keeps its count, sum,
+ * min and max and a histogram of log2 bins, so a sample costs a few adds
+ * and nothing is printed until led_stats_dump() is called.
+ *
+ * Blocked time is collected as it happens with led_stats_stall() and
+ * handed out per frame with led_stats_stalled(). Only core 0, the core
+ * that renders, counts it. Wire time is measured by led_dma.h from the
+ * start of a frame to its latch, so it is only recorded for frames sent
+ * by DMA. Without DMA the CPU pushes each word and the time shows up as
+ * blocked instead.
+ */
+
+#ifndef LED_STATS_H
+#define LED_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+
+/**
+ * @brief Histogram bins, bin n counting samples of 2^(n-1) to 2^n - 1 us
+ * and the last anything longer.
+ */
+#define LED_STATS_BINS (20)
+
+/**
+ * @brief The measures.
+ */
+typedef enum led_stats_id_e {
+    LED_STATS_RENDER = 0,               // Rendering a frame, less time blocked.
+    LED_STATS_WIRE,                     // Sending a frame by DMA, up to the latch.
+    LED_STATS_BLOCKED,                  // Waiting for the PIO FIFO or the DMA during a frame.
+    LED_STATS_PERIOD,                   // Time since the frame before.
+    LED_STATS_LATE,                     // Scheduler wake up after the deadline.
+    LED_STATS_COUNT
+} led_stats_id_t;
+
+/**
+ * @brief One measure.
+ */
+typedef struct led_stats_measure_s {
+    uint32_t count;                     // Samples.
+    uint32_t min_us;                    // Shortest sample.
+    uint32_t max_us;                    // Longest sample.
+    uint64_t sum_us;                    // Total of the samples.
+    uint32_t bins[LED_STATS_BINS];      // Samples in each log2 bin.
+} led_stats_measure_t;
+
+/**
+ * @brief Clear every measure, at the start of a pattern.
+ */
+void led_stats_reset(void);
+
+/**
+ * @brief Add a sample to a measure.
+ * @details Each measure is written from one place only, so this is safe
+ * from the DMA interrupt for LED_STATS_WIRE.
+ *
+ * @param id The measure.
+ * @param us The sample (in us).
+ */
+void led_stats_add(led_stats_id_t id, uint32_t us);
+
+/**
+ * @brief Add the interval since the last call to LED_STATS_PERIOD.
+ * @details Called once per frame presented. The first call after
+ * led_stats_reset() only starts the interval.
+ */
+void led_stats_frame(void);
+
+/**
+ * @brief Count time spent blocked.
+ *
+ * @param us Time blocked (in us).
+ */
+void led_stats_stall(uint32_t us);
+
+/**
+ * @brief Get the time blocked so far.
+ * @details The difference between two readings is the time blocked
+ * between them.
+ *
+ * @return uint32_t Running total (in us), wraps.
+ */
+uint32_t led_stats_stalled(void);
+
+/**
+ * @brief Copy a measure.
+ *
+ * @param id The measure.
+ * @param measure Filled with a consistent copy.
+ */
+void led_stats_get(led_stats_id_t id, led_stats_measure_t *measure);
+
+/**
+ * @brief Print the min/avg/max of each measure and the achieved frame rate
+ * on stdio.
+ *
+ * @param histograms True to add the non-empty bins of each histogram.
+ */
+void led_stats_dump(bool histograms);
+
+/**
+ * @brief Write a word to the PIO, counting any time the FIFO is full.
+ *
+ * @param pio The PIO.
+ * @param sm The state machine.
+ * @param word The word.
+ */
+static inline void led_stats_put_blocking(PIO pio, uint sm, uint32_t word) {
+    if (pio_sm_is_tx_fifo_full(pio, sm)) {
+        uint32_t start = time_us_32();
+        pio_sm_put_blocking(pio, sm, word);
+        led_stats_stall(time_us_32() - start);
+    }
+    else {
+        pio_sm_put_blocking(pio, sm, word);
+    }
+}
+
+#endif // LED_STATS_H
+
+/* End. */
@@ -0,0 +1,108 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Framebuffer-less streaming of generated pixels to the LED string.
+ */
+
+#include "pico/stdlib.h"
+#include "led_dma.h"
+#include "led_stats.h"
+#include "led_stream.h"
+#include "led_wire.h"
+
+/**
+ * @brief A pixel generator and its context, for rendering it in tiles.
+ */
+typedef struct led_stream_gen_s {
+    led_stream_pixel_t pixel;           // The generator.
+    const void *context;                // Passed to the generator.
+} led_stream_gen_t;
+
+// Operating data.
+static PIO                      led_stream_pio;                 // PIO running the ws2812 program.
+static uint                     led_stream_sm;                  // State machine being fed.
+static bool                     led_stream_dma = false;         // Tiles are sent by DMA.
+static uint32_t                 led_stream_buf[2][LED_STREAM_TILE_MAX]; // Ping-pong tile buffers.
+
+/**
+ * @brief Render a tile from a pixel generator.
+ * 
+ * @param context A led_stream_gen_t.
+ * @param tile Filled with the pixels.
+ * @param first Index of the first pixel.
+ * @param count Pixels in the tile.
+ * @param t Frame time.
+ */
+static void led_stream_generate(const void *context, uint32_t *tile, size_t first, size_t count, uint32_t t) {
+    const led_stream_gen_t *gen = context;
+    for (size_t n = 0; n < count; n++) {
+        tile[n] = gen->pixel(gen->context, first + n, t);
+    }
+}
+
+void led_stream_init(PIO pio, uint sm, bool use_dma) {
+    led_stream_pio = pio;
+    led_stream_sm = sm;
+    led_stream_dma = use_dma;
+}
+
+void led_stream_frame(led_stream_pixel_t pixel, const void *context, size_t count, uint32_t t) {
+    led_stream_gen_t gen = { pixel, context };
+    led_stream_tiles(led_stream_generate, &gen, LED_STREAM_CHUNK, count, t);
+}
+
+/**
+ * @brief Render and send a frame a tile at a time.
+ * 
+ * @param tile The tile renderer.
+ * @param context Passed to the renderer.
+ * @param tile_size Pixels in each tile.
+ * @param count Pixels in the frame.
+ * @param t Frame time, passed to the renderer.
+ * @param encode True if the renderer gives rgb_u32() pixels, false if it
+ * gives wire words.
+ */
+static void led_stream_send(led_stream_tile_t tile, const void *context, size_t tile_size, size_t count, uint32_t t, bool encode) {
+    if (tile_size == 0 || tile_size > LED_STREAM_TILE_MAX) {
+        tile_size = LED_STREAM_TILE_MAX;
+    }
+
+    // Fill one buffer while the other is on the wire. Starting a part waits
+    // for the one before, which was read from the buffer about to be filled.
+    size_t first = 0;
+    uint buf = 0;
+    while (first < count) {
+        size_t size = count - first;
+        if (size > tile_size) {
+            size = tile_size;
+        }
+        uint32_t *words = led_stream_buf[buf];
+        tile(context, words, first, size, t);
+        if (encode) {
+            led_wire_encode(words, words, size);
+        }
+        first += size;
+
+        // Without DMA the PIO sets the pace, the FIFO holds the end of the
+        // last tile while the next is rendered.
+        if (led_stream_dma) {
+            led_dma_start_part(words, size, first == count);
+            buf ^= 1u;
+        }
+        else {
+            for (size_t n = 0; n < size; n++) {
+                led_stats_put_blocking(led_stream_pio, led_stream_sm, words[n]);
+            }
+        }
+    }
+}
+
+void led_stream_tiles(led_stream_tile_t tile, const void *context, size_t tile_size, size_t count, uint32_t t) {
+    led_stream_send(tile, context, tile_size, count, t, true);
+}
+
+void led_stream_wire_tiles(led_stream_tile_t tile, const void *context, size_t tile_size, size_t count, uint32_t t) {
+    led_stream_send(tile, context, tile_size, count, t, false);
+}
+
+/* End. */
@@ -0,0 +1,98 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Framebuffer-less streaming of generated pixels to the LED string.
+ *
+ * A frame is rendered a tile (a page of consecutive pixels) at a time into
+ * two small ping-pong buffers, then gamma corrected and encoded in place.
+ * DMA sends one tile while the next is rendered, so rendering overlaps the
+ * wire at tile granularity and RAM use does not depend on the length of the
+ * string. Tiles come from a tile renderer, or from a generator, f(index, t),
+ * called for each pixel. Without DMA the words go straight to the PIO TX
+ * FIFO.
+ */
+
+#ifndef LED_STREAM_H
+#define LED_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hardware/pio.h"
+
+/**
+ * @brief The largest tile, in pixels.
+ */
+#define LED_STREAM_TILE_MAX (64)
+
+/**
+ * @brief Pixels generated and sent in each DMA transfer by led_stream_frame().
+ * @details Rendering a tile must take less time than sending one (30us a
+ * pixel), and the next transfer must start before the TX FIFO drains. The
+ * FIFO is joined to 8 words, so that leaves 240us of slack between tiles.
+ */
+#define LED_STREAM_CHUNK (32)
+
+/**
+ * @brief Generates one rgb_u32() pixel of a frame.
+ * @details Called for every pixel of a frame in order, from index 0.
+ */
+typedef uint32_t (*led_stream_pixel_t)(const void *context, size_t index, uint32_t t);
+
+/**
+ * @brief Renders rgb_u32() pixels first to first + count - 1 of a frame.
+ * @details Called for each tile of a frame in order, from pixel 0.
+ */
+typedef void (*led_stream_tile_t)(const void *context, uint32_t *tile, size_t first, size_t count, uint32_t t);
+
+/**
+ * @brief Set up streaming to a state machine running the ws2812 program.
+ * 
+ * @param pio PIO handle.
+ * @param sm State machine identifier.
+ * @param use_dma True if led_dma_init() succeeded.
+ */
+void led_stream_init(PIO pio, uint sm, bool use_dma);
+
+/**
+ * @brief Generate and send a frame.
+ * @details Returns once the last chunk has started, the frame then latches
+ * while the caller carries on.
+ * 
+ * @param pixel The pixel generator.
+ * @param context Passed to the generator.
+ * @param count Pixels in the frame.
+ * @param t Frame time, passed to the generator.
+ */
+void led_stream_frame(led_stream_pixel_t pixel, const void *context, size_t count, uint32_t t);
+
+/**
+ * @brief Render and send a frame a tile at a time.
+ * @details Returns once the last tile has started, the frame then latches
+ * while the caller carries on.
+ * 
+ * @param tile The tile renderer.
+ * @param context Passed to the renderer.
+ * @param tile_size Pixels in each tile, at most LED_STREAM_TILE_MAX.
+ * @param count Pixels in the frame.
+ * @param t Frame time, passed to the renderer.
+ */
+void led_stream_tiles(led_stream_tile_t tile, const void *context, size_t tile_size, size_t count, uint32_t t);
+
+/**
+ * @brief Send a frame a tile at a time, rendered straight to wire format.
+ * @details As led_stream_tiles(), but the renderer fills each tile with
+ * led_wire_t words, which are sent as they are.
+ * 
+ * @param tile The tile renderer, giving wire words.
+ * @param context Passed to the renderer.
+ * @param tile_size Pixels in each tile, at most LED_STREAM_TILE_MAX.
+ * @param count Pixels in the frame.
+ * @param t Frame time, passed to the renderer.
+ */
+void led_stream_wire_tiles(led_stream_tile_t tile, const void *context, size_t tile_size, size_t count, uint32_t t);
+
+#endif // LED_STREAM_H
+
+/* End. */
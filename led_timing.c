@@ -0,0 +1,113 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * LED timing profiles for the ws2812 PIO programs.
+ */
+
+#include <string.h>
+
+#include "led_timing.h"
+
+/**
+ * @brief The profiles, from the LED datasheets.
+ * @details The fast WS2812B profile keeps the high times and shortens the
+ * low times towards the datasheet minimum, as (7,10,8) does.
+ */
+const led_timing_profile_t led_timing_profiles[] = {
+    { "ws2812",         350,    700,    800000 },
+    { "ws2812b-fast",   350,    750,    900000 },
+    { "sk6812",         300,    600,    800000 },
+    { "ws2811",         500,    1200,   400000 },
+};
+const size_t led_timing_profiles_count = sizeof(led_timing_profiles) / sizeof(led_timing_profiles[0]);
+
+/**
+ * @brief Difference between two times.
+ */
+static uint64_t led_timing_error(uint64_t a, uint64_t b) {
+    return (a > b) ? a - b : b - a;
+}
+
+const led_timing_profile_t *led_timing_find(const char *name) {
+    for (size_t idx = 0; idx < led_timing_profiles_count; idx++) {
+        if (strcmp(led_timing_profiles[idx].name, name) == 0) {
+            return &led_timing_profiles[idx];
+        }
+    }
+    return NULL;
+}
+
+bool led_timing_solve(const led_timing_profile_t *profile, uint32_t sys_hz, bool parallel, led_timing_t *timing) {
+    uint32_t max_cycles = parallel ? 32 : 16;
+    uint64_t t0h_ps = profile->t0h_ns * 1000ull;
+    uint64_t t1h_ps = profile->t1h_ns * 1000ull;
+    uint64_t bit_ps = 1000000000000ull / profile->bit_hz;
+    uint64_t best = UINT64_MAX;
+
+    // Each divider gives a cycle time, try the cycle counts either side of
+    // the bit period and every split of it.
+    for (uint32_t div = 1; div <= 65535u; div++) {
+        uint64_t cycle_ps = (div * 1000000000000ull) / sys_hz;
+        uint32_t cycles = (uint32_t) (bit_ps / cycle_ps);
+        if (cycles < 4) {
+            break;
+        }
+        for (uint32_t n = cycles; n <= cycles + 1; n++) {
+            if (n > max_cycles * 3) {
+                continue;
+            }
+            for (uint32_t t1 = 1; t1 <= max_cycles; t1++) {
+                for (uint32_t t2 = 1; t2 <= max_cycles && t1 + t2 + 2 <= n; t2++) {
+                    uint32_t t3 = n - t1 - t2;
+                    if (t3 > max_cycles) {
+                        continue;
+                    }
+                    uint64_t cost = led_timing_error(t1 * cycle_ps, t0h_ps) +
+                                    led_timing_error((t1 + t2) * cycle_ps, t1h_ps) +
+                                    led_timing_error(n * cycle_ps, bit_ps);
+                    if (cost < best) {
+                        best = cost;
+                        timing->t1 = (uint8_t) t1;
+                        timing->t2 = (uint8_t) t2;
+                        timing->t3 = (uint8_t) t3;
+                        timing->div = (uint16_t) div;
+                    }
+                }
+            }
+        }
+    }
+    if (best == UINT64_MAX) {
+        return false;
+    }
+
+    // Report the timing from the exact cycle time.
+    uint64_t cycle_ps = (timing->div * 1000000000000ull) / sys_hz;
+    timing->t0h_ns = (uint32_t) ((timing->t1 * cycle_ps + 500u) / 1000u);
+    timing->t1h_ns = (uint32_t) (((timing->t1 + timing->t2) * cycle_ps + 500u) / 1000u);
+    timing->bit_ns = (uint32_t) (((timing->t1 + timing->t2 + timing->t3) * cycle_ps + 500u) / 1000u);
+    return true;
+}
+
+void led_timing_patch(pio_program_t *patched, uint16_t *instructions, const pio_program_t *program, bool parallel, const led_timing_t *timing) {
+    memcpy(instructions, program->instructions, program->length * sizeof(uint16_t));
+    if (parallel) {
+
+        // mov pins, !null [T1-1]; mov pins, x [T2-1]; mov pins, null [T3-2]
+        uint delays[4] = {0, timing->t1 - 1u, timing->t2 - 1u, timing->t3 - 2u};
+        for (int idx = 1; idx < 4; idx++) {
+            instructions[idx] = (uint16_t) ((instructions[idx] & ~0x1f00u) | ((delays[idx] & 0x1fu) << 8));
+        }
+    }
+    else {
+
+        // out [T3-1]; jmp [T1-1]; jmp [T2-1]; nop [T2-1] (after 1 side-set bit)
+        uint delays[4] = {timing->t3 - 1u, timing->t1 - 1u, timing->t2 - 1u, timing->t2 - 1u};
+        for (int idx = 0; idx < 4; idx++) {
+            instructions[idx] = (uint16_t) ((instructions[idx] & ~0x0f00u) | ((delays[idx] & 0x0fu) << 8));
+        }
+    }
+    *patched = *program;
+    patched->instructions = instructions;
+}
+
+/* End. */
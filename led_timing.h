@@ -0,0 +1,106 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * LED timing profiles for the ws2812 PIO programs.
+ *
+ * Each bit starts with T1 cycles high, then T2 cycles that are high for a 1
+ * and low for a 0, then T3 cycles low. ws2812.pio assembles fixed values,
+ * and its init functions derive a fractional clock divider for the bit rate,
+ * which adds a cycle of jitter to some edges. A profile instead gives the
+ * high times and bit rate a LED type wants, and led_timing_solve() searches
+ * the cycle counts and an integer divider for the closest fit at the current
+ * clk_sys. The delays are then patched into a copy of the program before it
+ * is loaded.
+ */
+
+#ifndef LED_TIMING_H
+#define LED_TIMING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hardware/pio.h"
+
+/**
+ * @brief Profile indices into led_timing_profiles[].
+ */
+#define LED_TIMING_WS2812       (0)     // WS2812, 800kHz.
+#define LED_TIMING_WS2812B_FAST (1)     // WS2812B, short low times, 900kHz.
+#define LED_TIMING_SK6812       (2)     // SK6812, 800kHz.
+#define LED_TIMING_WS2811       (3)     // WS2811 in slow mode, 400kHz.
+
+/**
+ * @brief Target timing for a LED type.
+ */
+typedef struct led_timing_profile_s {
+    const char *name;                   // Profile name.
+    uint16_t t0h_ns;                    // High time of a 0 bit.
+    uint16_t t1h_ns;                    // High time of a 1 bit.
+    uint32_t bit_hz;                    // Bit rate.
+} led_timing_profile_t;
+
+/**
+ * @brief Cycle counts and divider chosen for a profile, and the timing they
+ * give.
+ */
+typedef struct led_timing_s {
+    uint8_t t1;                         // Cycles high for every bit.
+    uint8_t t2;                         // Cycles high for a 1, low for a 0.
+    uint8_t t3;                         // Cycles low for every bit.
+    uint16_t div;                       // Integer clock divider.
+    uint32_t t0h_ns;                    // Achieved 0 bit high time.
+    uint32_t t1h_ns;                    // Achieved 1 bit high time.
+    uint32_t bit_ns;                    // Achieved bit period.
+} led_timing_t;
+
+/**
+ * @brief The profiles, indexed by LED_TIMING_WS2812 etc.
+ */
+extern const led_timing_profile_t led_timing_profiles[];
+
+/**
+ * @brief Number of entries in led_timing_profiles[].
+ */
+extern const size_t led_timing_profiles_count;
+
+/**
+ * @brief Find a profile by name.
+ * 
+ * @param name The profile name, for example "sk6812".
+ * @return const led_timing_profile_t* The profile, or NULL if there is none.
+ */
+const led_timing_profile_t *led_timing_find(const char *name);
+
+/**
+ * @brief Find the cycle counts and integer divider closest to a profile.
+ * @details Minimises the sum of the errors in the two high times and the
+ * bit period. The ws2812 program's delays hold up to 16 cycles, those of
+ * ws2812_parallel up to 32, and T3 is at least 2 cycles.
+ * 
+ * @param profile The target timing.
+ * @param sys_hz The system clock.
+ * @param parallel True for the ws2812_parallel program.
+ * @param timing Filled with the result.
+ * @return true A fit was found.
+ * @return false The profile cannot be met at this clock.
+ */
+bool led_timing_solve(const led_timing_profile_t *profile, uint32_t sys_hz, bool parallel, led_timing_t *timing);
+
+/**
+ * @brief Copy a ws2812 or ws2812_parallel program with its
+ * delays set from a timing.
+ * @details The copy refers to the instructions, which must stay in place
+ * while the program is loaded.
+ * 
+ * @param patched Filled with the program.
+ * @param instructions Space for the program's instructions.
+ * @param program The assembled program.
+ * @param parallel True for the ws2812_parallel program.
+ * @param timing The cycle counts.
+ */
+void led_timing_patch(pio_program_t *patched, uint16_t *instructions, const pio_program_t *program, bool parallel, const led_timing_t *timing);
+
+#endif // LED_TIMING_H
+
+/* End. */
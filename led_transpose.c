@@ -0,0 +1,202 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Bit-plane transposition for the ws2812_parallel program.
+ *
+ * The kernels only use 32 bit operations as the Cortex-M0+ has no 64 bit
+ * shifts, and keep the working set small enough for its eight low registers
+ * where they can. Bit and byte moves are done with delta swaps: two fields
+ * "shift" bits apart are exchanged wherever "mask" is set.
+ */
+
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "led_transpose.h"
+
+/**
+ * @brief Exchange bits of a and b: (a >> shift) & mask with b & mask.
+ */
+#define DELTA_SWAP(a, b, shift, mask) do {                          \
+        uint32_t _t = (((a) >> (shift)) ^ (b)) & (mask);            \
+        (b) ^= _t;                                                  \
+        (a) ^= _t << (shift);                                       \
+    } while (0)
+
+/**
+ * @brief Exchange bits within x: (x >> shift) & mask with x & mask.
+ */
+#define DELTA_SWAP1(x, shift, mask) do {                            \
+        uint32_t _t = ((x) ^ ((x) >> (shift))) & (mask);            \
+        (x) ^= _t ^ (_t << (shift));                                \
+    } while (0)
+
+/**
+ * @brief Transpose a 4x4 byte matrix, one row per word.
+ * @details Byte j of row i moves to byte i of row j.
+ */
+#define TRANSPOSE_4X4_BYTES(r0, r1, r2, r3) do {                    \
+        DELTA_SWAP(r0, r1, 8, 0x00ff00ffu);                         \
+        DELTA_SWAP(r2, r3, 8, 0x00ff00ffu);                         \
+        DELTA_SWAP(r0, r2, 16, 0x0000ffffu);                        \
+        DELTA_SWAP(r1, r3, 16, 0x0000ffffu);                        \
+    } while (0)
+
+/**
+ * @brief Transpose an 8x8 bit matrix, rows 0-3 in the bytes of lo and rows
+ * 4-7 in the bytes of hi.
+ * @details Bit j of row i moves to bit i of row j (Hacker's Delight 7-3,
+ * split into 32 bit halves).
+ */
+#define TRANSPOSE_8X8_BITS(lo, hi) do {                             \
+        DELTA_SWAP1(lo, 7, 0x00aa00aau);                            \
+        DELTA_SWAP1(hi, 7, 0x00aa00aau);                            \
+        DELTA_SWAP1(lo, 14, 0x0000ccccu);                           \
+        DELTA_SWAP1(hi, 14, 0x0000ccccu);                           \
+        uint32_t _t = ((lo) ^ ((hi) << 4)) & 0xf0f0f0f0u;           \
+        (lo) ^= _t;                                                 \
+        (hi) ^= _t >> 4;                                            \
+    } while (0)
+
+/**
+ * @brief Transpose one pixel from 8 consecutive strings.
+ * @details On return lo[c] and hi[c] hold colour byte c (0 = bits 23-16)
+ * transposed: byte j of lo (j < 4) or hi (j >= 4) is bit j of that colour
+ * for all 8 strings.
+ * 
+ * @param px First string's pixel, the others follow at "stride".
+ * @param stride Distance between strings.
+ * @param lo Rows 0-3 for each colour byte.
+ * @param hi Rows 4-7 for each colour byte.
+ */
+static inline __attribute__((always_inline)) void led_transpose_group8(const uint32_t *px, size_t stride, uint32_t lo[3], uint32_t hi[3]) {
+
+    // Gather by colour: word 0 holds the blue bytes, 1 green, 2 red.
+    uint32_t a0 = px[0 * stride], a1 = px[1 * stride], a2 = px[2 * stride], a3 = px[3 * stride];
+    uint32_t b0 = px[4 * stride], b1 = px[5 * stride], b2 = px[6 * stride], b3 = px[7 * stride];
+    TRANSPOSE_4X4_BYTES(a0, a1, a2, a3);
+    TRANSPOSE_4X4_BYTES(b0, b1, b2, b3);
+
+    TRANSPOSE_8X8_BITS(a2, b2);
+    TRANSPOSE_8X8_BITS(a1, b1);
+    TRANSPOSE_8X8_BITS(a0, b0);
+    lo[0] = a2;
+    hi[0] = b2;
+    lo[1] = a1;
+    hi[1] = b1;
+    lo[2] = a0;
+    hi[2] = b0;
+}
+
+void led_transpose_8(uint32_t *planes, const uint32_t *strips, size_t stride, size_t count) {
+    for (size_t px = 0; px < count; px++, planes += LED_TRANSPOSE_BITS) {
+        uint32_t lo[3], hi[3];
+        led_transpose_group8(strips + px, stride, lo, hi);
+        for (int c = 0; c < 3; c++) {
+            uint32_t *plane = planes + 8 * c;
+            plane[0] = hi[c] >> 24;
+            plane[1] = (hi[c] >> 16) & 0xffu;
+            plane[2] = (hi[c] >> 8) & 0xffu;
+            plane[3] = hi[c] & 0xffu;
+            plane[4] = lo[c] >> 24;
+            plane[5] = (lo[c] >> 16) & 0xffu;
+            plane[6] = (lo[c] >> 8) & 0xffu;
+            plane[7] = lo[c] & 0xffu;
+        }
+    }
+}
+
+void led_transpose_16(uint32_t *planes, const uint32_t *strips, size_t stride, size_t count) {
+    for (size_t px = 0; px < count; px++, planes += LED_TRANSPOSE_BITS) {
+        uint32_t lo0[3], hi0[3], lo1[3], hi1[3];
+        led_transpose_group8(strips + px, stride, lo0, hi0);
+        led_transpose_group8(strips + 8 * stride + px, stride, lo1, hi1);
+
+        // Zip the bytes of the two groups into half words.
+        for (int c = 0; c < 3; c++) {
+            uint32_t *plane = planes + 8 * c;
+            for (int j = 0; j < 4; j++) {
+                uint shift = 24 - 8 * j;
+                plane[j] = ((hi0[c] >> shift) & 0xffu) | (((hi1[c] >> shift) & 0xffu) << 8);
+                plane[j + 4] = ((lo0[c] >> shift) & 0xffu) | (((lo1[c] >> shift) & 0xffu) << 8);
+            }
+        }
+    }
+}
+
+void led_transpose_32(uint32_t *planes, const uint32_t *strips, size_t stride, size_t count) {
+    for (size_t px = 0; px < count; px++, planes += LED_TRANSPOSE_BITS) {
+
+        // Row 31 - lane holds the lane's pixel, so after the transpose row
+        // 31 - bit holds that bit with lane "lane" in bit "lane".
+        uint32_t a[32];
+        for (int lane = 0; lane < 32; lane++) {
+            a[31 - lane] = strips[lane * stride + px];
+        }
+
+        // Hacker's Delight 7-3 transpose32, swapping ever smaller blocks.
+        uint32_t m = 0x0000ffffu;
+        for (int j = 16; j != 0; j >>= 1, m ^= m << j) {
+            for (int k = 0; k < 32; k = (k + j + 1) & ~j) {
+                uint32_t t = (a[k] ^ (a[k + j] >> j)) & m;
+                a[k] ^= t;
+                a[k + j] ^= t << j;
+            }
+        }
+
+        // Rows 0-7 hold the unused top byte.
+        memcpy(planes, &a[8], LED_TRANSPOSE_BITS * sizeof(uint32_t));
+    }
+}
+
+void led_transpose_any(uint32_t *planes, const uint32_t *strips, unsigned lanes, size_t stride, size_t count) {
+    for (size_t px = 0; px < count; px++, planes += LED_TRANSPOSE_BITS) {
+        memset(planes, 0, LED_TRANSPOSE_BITS * sizeof(uint32_t));
+
+        // Eight lanes at a time, missing lanes read as zero.
+        for (unsigned group = 0; group < lanes; group += 8) {
+            unsigned group_lanes = (lanes - group < 8) ? lanes - group : 8;
+            uint32_t row[8] = {0};
+            for (unsigned lane = 0; lane < group_lanes; lane++) {
+                row[lane] = strips[(group + lane) * stride + px];
+            }
+            uint32_t lo[3], hi[3];
+            led_transpose_group8(row, 1, lo, hi);
+            for (int c = 0; c < 3; c++) {
+                uint32_t *plane = planes + 8 * c;
+                for (int j = 0; j < 4; j++) {
+                    uint shift = 24 - 8 * j;
+                    plane[j] |= ((hi[c] >> shift) & 0xffu) << group;
+                    plane[j + 4] |= ((lo[c] >> shift) & 0xffu) << group;
+                }
+            }
+        }
+    }
+}
+
+led_transpose_kernel_t led_transpose_kernel(unsigned lanes) {
+    switch (lanes) {
+        case 8:
+            return led_transpose_8;
+        case 16:
+            return led_transpose_16;
+        case 32:
+            return led_transpose_32;
+        default:
+            return NULL;
+    }
+}
+
+void led_transpose_reference(uint32_t *planes, const uint32_t *strips, unsigned lanes, size_t stride, size_t count) {
+    for (size_t px = 0; px < count; px++, planes += LED_TRANSPOSE_BITS) {
+        for (int bit = 0; bit < LED_TRANSPOSE_BITS; bit++) {
+            uint32_t word = 0;
+            for (unsigned lane = 0; lane < lanes; lane++) {
+                word |= ((strips[lane * stride + px] >> (23 - bit)) & 1u) << lane;
+            }
+            planes[bit] = word;
+        }
+    }
+}
+
+/* End. */
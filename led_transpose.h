@@ -0,0 +1,96 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Bit-plane transposition for the ws2812_parallel program.
+ *
+ * Every kernel writes 24 plane words per pixel. Plane word n holds bit
+ * (23 - n % 24) of pixel n / 24 of every string, with string "lane" in bit
+ * "lane", which is the order ws2812_parallel shifts them out. The strings
+ * are laid end to end in the source, stride pixels apart, and the first
+ * count pixels of each are transposed, so a prefix of the strings can be
+ * sent without transposing the rest.
+ */
+
+#ifndef LED_TRANSPOSE_H
+#define LED_TRANSPOSE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Plane words per pixel.
+ */
+#define LED_TRANSPOSE_BITS (24)
+
+/**
+ * @brief A kernel for a fixed number of strings.
+ */
+typedef void (*led_transpose_kernel_t)(uint32_t *planes, const uint32_t *strips, size_t stride, size_t count);
+
+/**
+ * @brief Transpose exactly 8 strings (register resident 8x8 SWAR transpose).
+ * 
+ * @param planes Destination, 24 words per pixel.
+ * @param strips The strings laid end to end.
+ * @param stride Distance between the strings (in pixels).
+ * @param count Pixels to transpose from the start of each string.
+ */
+void led_transpose_8(uint32_t *planes, const uint32_t *strips, size_t stride, size_t count);
+
+/**
+ * @brief Transpose exactly 16 strings (two 8x8 SWAR transposes per byte).
+ * 
+ * @param planes Destination, 24 words per pixel.
+ * @param strips The strings laid end to end.
+ * @param stride Distance between the strings (in pixels).
+ * @param count Pixels to transpose from the start of each string.
+ */
+void led_transpose_16(uint32_t *planes, const uint32_t *strips, size_t stride, size_t count);
+
+/**
+ * @brief Transpose exactly 32 strings (32x32 block transpose).
+ * 
+ * @param planes Destination, 24 words per pixel.
+ * @param strips The strings laid end to end.
+ * @param stride Distance between the strings (in pixels).
+ * @param count Pixels to transpose from the start of each string.
+ */
+void led_transpose_32(uint32_t *planes, const uint32_t *strips, size_t stride, size_t count);
+
+/**
+ * @brief Transpose any number of strings up to 32, 8 at a time.
+ * @details Used for lane counts without a specialised kernel.
+ * 
+ * @param planes Destination, 24 words per pixel.
+ * @param strips The strings laid end to end.
+ * @param lanes Number of strings.
+ * @param stride Distance between the strings (in pixels).
+ * @param count Pixels to transpose from the start of each string.
+ */
+void led_transpose_any(uint32_t *planes, const uint32_t *strips, unsigned lanes, size_t stride, size_t count);
+
+/**
+ * @brief Reference transpose, one bit at a time.
+ * 
+ * @param planes Destination, 24 words per pixel.
+ * @param strips The strings laid end to end.
+ * @param lanes Number of strings.
+ * @param stride Distance between the strings (in pixels).
+ * @param count Pixels to transpose from the start of each string.
+ */
+void led_transpose_reference(uint32_t *planes, const uint32_t *strips, unsigned lanes, size_t stride, size_t count);
+
+/**
+ * @brief Get the kernel specialised for a lane count.
+ * @details Called once when the lane count is known, so each frame calls
+ * the kernel directly.
+ * 
+ * @param lanes Number of strings.
+ * @return led_transpose_kernel_t The kernel, or NULL if there is none and
+ * led_transpose_any() should be used.
+ */
+led_transpose_kernel_t led_transpose_kernel(unsigned lanes);
+
+#endif // LED_TRANSPOSE_H
+
+/* End. */
@@ -0,0 +1,27 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Wire format LED pixels.
+ */
+
+#include "led_wire.h"
+
+void led_wire_encode(led_wire_t *dst, const uint32_t *src, size_t count) {
+    for (size_t idx = 0; idx < count; idx++) {
+        *dst++ = led_wire_from_pixel(*src++);
+    }
+}
+
+void led_wire_decode(uint32_t *dst, const led_wire_t *src, size_t count) {
+    for (size_t idx = 0; idx < count; idx++) {
+        *dst++ = led_wire_to_pixel(*src++);
+    }
+}
+
+void led_wire_fill(led_wire_t *dst, size_t count, led_wire_t word) {
+    for (size_t idx = 0; idx < count; idx++) {
+        *dst++ = word;
+    }
+}
+
+/* End. */
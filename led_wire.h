@@ -0,0 +1,82 @@
+/**
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Wire format LED pixels.
+ *
+ * The ws2812 program shifts each word out MSB first and pulls after 24
+ * bits, so a pixel is sent as its gamma corrected rgb_u32() value moved to
+ * the top 24 bits. A frame held in this form can be read by the DMA as it
+ * is, with no pass over it before sending. Patterns work in rgb_u32()
+ * pixels, and these helpers convert at the boundary between the two.
+ */
+
+#ifndef LED_WIRE_H
+#define LED_WIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "led_gamma.h"
+
+/**
+ * @brief Left shift of the pixel in a wire word.
+ */
+#define LED_WIRE_SHIFT (8)
+
+/**
+ * @brief A pixel in wire format, corrected and aligned for the PIO.
+ */
+typedef uint32_t led_wire_t;
+
+/**
+ * @brief Convert one rgb_u32() pixel to wire format.
+ * @details The pixel is gamma corrected and scaled by the global brightness.
+ * 
+ * @param pixel The linear pixel.
+ * @return led_wire_t The wire word.
+ */
+static inline led_wire_t led_wire_from_pixel(uint32_t pixel) {
+    return led_gamma_pixel(pixel) << LED_WIRE_SHIFT;
+}
+
+/**
+ * @brief Convert a wire word back to a pixel.
+ * @details The gamma correction is not undone.
+ * 
+ * @param word The wire word.
+ * @return uint32_t The corrected rgb_u32() pixel.
+ */
+static inline uint32_t led_wire_to_pixel(led_wire_t word) {
+    return word >> LED_WIRE_SHIFT;
+}
+
+/**
+ * @brief Convert rgb_u32() pixels to wire format.
+ * 
+ * @param dst Destination words, may be the same as src.
+ * @param src Source pixels.
+ * @param count The number of pixels.
+ */
+void led_wire_encode(led_wire_t *dst, const uint32_t *src, size_t count);
+
+/**
+ * @brief Convert wire words back to corrected rgb_u32() pixels.
+ * 
+ * @param dst Destination pixels, may be the same as src.
+ * @param src Source words.
+ * @param count The number of pixels.
+ */
+void led_wire_decode(uint32_t *dst, const led_wire_t *src, size_t count);
+
+/**
+ * @brief Set every word of a wire format frame.
+ * 
+ * @param dst Destination words.
+ * @param count The number of pixels.
+ * @param word The wire word, from led_wire_from_pixel().
+ */
+void led_wire_fill(led_wire_t *dst, size_t count, led_wire_t word);
+
+#endif // LED_WIRE_H
+
+/* End. */
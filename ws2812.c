@@ -6,6 +6,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "pico/stdlib.h"
 #include "hardware/pio.h"
@@ -13,6 +14,20 @@
 #include "hardware/gpio.h"
 #include "hardware/watchdog.h"
 #include "ws2812.pio.h"
+#include "led_anim.h"
+#include "led_bufops.h"
+#include "led_dma.h"
+#include "led_frames.h"
+#include "led_packed.h"
+#include "led_palette.h"
+#include "led_parallel.h"
+#include "led_patterns.h"
+#include "led_sched.h"
+#include "led_scroll.h"
+#include "led_stats.h"
+#include "led_stream.h"
+#include "led_timing.h"
+#include "led_wire.h"
 
 /**
  * NOTE:
@@ -27,77 +42,62 @@
  *  When RGBW is used with rgb_u32(), the White channel will be ignored (off).
  *
  */
-#define NUM_PIXELS  (100)
-#define NUM_PERPAGE (4)
-#define NUM_PAGES   (NUM_PIXELS / NUM_PERPAGE)
+#ifndef NUM_PIXELS
+#define NUM_PIXELS  (100)   // Pixels in each string.
+#endif
+#define NUM_PERPAGE (32)    // Pixels in each tile rendered with LED_STREAM, LED_PACKED or LED_PALETTE.
+#define NUM_PAGES   ((NUM_PIXELS + NUM_PERPAGE - 1) / NUM_PERPAGE)
 #define LED_PIN     (28)
 #define MODE_PIN    (16)
-
-/**
- * @brief Mode descriptions.
- * 
- */
-typedef enum string_mode_e {
-    MODE_CHASE_THREE = 0,
-    MODE_CROSS_FADE_ONE,
-    MODE_CHASE_THREE_SLOW,
-    MODE_CROSS_FADE_TWO,
-    MODE_COLOUR_CHASE_BLACK,
-    MODE_COLOUR_CHASE_COLOUR,
-    MODE_END
-    
-} STRING_MODE_t;
+#define LED_USE_DMA (1)     // Send frames by DMA, 0 for the blocking PIO writes.
+#define NUM_FRAMES  (2)     // Frame buffers, 2 (double) or 3 (triple) buffering.
+#ifndef NUM_STRIPS
+#define NUM_STRIPS  (1)     // Strings driven in parallel from STRIP_PIN, 1 for LED_PIN only.
+#endif
+#define STRIP_PIN   (2)     // First of NUM_STRIPS consecutive pins.
+#ifndef LED_STREAM
+#define LED_STREAM  (0)     // Generate pixels as they are sent, with no frame buffers.
+#endif
+#ifndef LED_PACKED
+#define LED_PACKED  (0)     // Hold frames as 3 bytes per pixel, pulled 32 bits at a time.
+#endif
+#ifndef LED_PALETTE
+#define LED_PALETTE (0)     // Hold frames as 8 bit palette indices, expanded as they are sent.
+#endif
+#ifndef LED_SCROLL
+#define LED_SCROLL  (0)     // Hold one frame and scroll it by sending from an offset.
+#endif
+#if (LED_STREAM || LED_PACKED || LED_PALETTE || LED_SCROLL) && NUM_STRIPS > 1
+#error "LED_STREAM, LED_PACKED, LED_PALETTE and LED_SCROLL drive a single string"
+#endif
+#if (LED_STREAM + LED_PACKED + LED_PALETTE + LED_SCROLL) > 1
+#error "LED_STREAM, LED_PACKED, LED_PALETTE and LED_SCROLL are alternatives"
+#endif
+#if (LED_STREAM || LED_PACKED || LED_PALETTE) && NUM_PERPAGE > LED_STREAM_TILE_MAX
+#error "NUM_PERPAGE is larger than a tile"
+#endif
+#ifndef LED_TIMING_NAME
+#define LED_TIMING_NAME "ws2812"    // Timing profile, see led_timing.c.
+#endif
+#define NUM_LEDS    (NUM_PIXELS * NUM_STRIPS)
 
 // Operating data.
 static volatile bool            led_pressed = false;            // Tracks when the button is pushed.
-static volatile int             led_pattern = 0;                // Which pattern is being displayed.
+static int                      led_pattern = 0;                // Which pattern is being displayed.
 static volatile absolute_time_t led_interrupt_start;            // Start of the last interrupt.
-
-/**
- * @brief Format a RGBw value to a pixel.
- * @details The ws2812b has GRB encoded LEDS, check for the encoding of your
- * specific LED type.
- * 
- * @param r Red value.
- * @param g Green value.
- * @param b Blue value.
- * @return uint32_t Formatted RGB value.
- */
-static inline uint32_t rgb_u32(uint8_t r, uint8_t g, uint8_t b) {
-    return ((uint32_t) (g) << 8) | ((uint32_t) (r) << 16) | (uint32_t) (b);
-}
-
-/**
- * @brief Write "array_size" elements to the WS2812b LED string.
- * 
- * @param pio PIO identifier.
- * @param sm State machine identifier.
- * @param array A pointer to an array of uint32_t values.
- * @param array_size The number of elements in the array.
- */
-static void led_array_write(PIO pio, uint sm, uint32_t *array, size_t array_size) {
-    for (size_t idx = 0; idx < array_size; idx++) {
-        pio_sm_put_blocking(pio, sm, (*array++) << 8u);
-    }
-}
-
-/**
- * @brief Set the led array to given colour.
- * 
- * @param array A pointer to an array of uint32_t values.
- * @param array_size The number of elements in the array.
- * @param colour RGB colour.
- */
-static void led_array_set(uint32_t *array, size_t array_size, uint32_t colour) {
-    for (size_t idx = 0; idx < array_size; idx++) {
-        *array++ = colour;
-    }
-}
+static absolute_time_t          led_switch_start = 0;           // Press that changed mode, until its first frame.
+static uint32_t                 led_switch_us = 0;              // Press to first frame of the current mode.
+static uint32_t                 led_switch_max_us = 0;          // Worst press to first frame.
+static const led_timing_profile_t *led_profile = NULL;          // Timing profile in use, NULL for the assembled timing.
+static led_timing_t             led_timing;                     // The profile fitted to clk_sys.
+static uint16_t                 led_instructions[8];            // The program with the profile's delays.
+static pio_program_t            led_program;                    // Refers to led_instructions.
 
 /**
  * @brief Get the interrupted state flag.
  * @details Returns the interrupt flag state. If the flag
- * is set, it is cleared and the set state is returned.
+ * is set, it is cleared and the set state is returned, and the
+ * caller moves on to the next pattern.
  * 
  * @return true An interrupt occurred.
  * @return false No interrupt event.
@@ -106,11 +106,9 @@ static bool get_interrupted(void) {
     bool ret;
 
     if ((ret = led_pressed) == true) {
-        led_pattern++;
-        if (led_pattern == MODE_END) {
-            led_pattern = 0;
-        }
-        // Release the interrupt.
+
+        // Release the interrupt, timing the switch from the press.
+        led_switch_start = led_interrupt_start;
         led_interrupt_start = get_absolute_time();
         led_pressed = false;
     }
@@ -138,279 +136,300 @@ void gpio_callback(uint gpio, uint32_t events) {
         if (events & GPIO_IRQ_LEVEL_LOW) {
             led_interrupt_start = get_absolute_time();
             led_pressed = true;
+
+            // Cut the pattern's frame wait short so it sees the press now.
+            led_sched_wake();
         }
     }
 }
 
+#if LED_STREAM || LED_PACKED
 /**
- * @brief Set the LED array to off.
- * 
- * @param pio PIO handle.
- * @param sm State machine identifier.
- * @param array Pointer to the LED array buffer.
- * @param array_size The number of LEDs in the array buffer.
+ * @brief Tile renderer for a string that is off.
  */
-static inline void clear_leds(PIO pio, int sm, uint32_t *array, size_t array_size) {
-    led_array_set(array, array_size, 0);
-    led_array_write(pio, sm, array, array_size);
+static void black_tile(const void *context, uint32_t *tile, size_t first, size_t count, uint32_t t) {
+    led_array_set(tile, count, 0);
 }
+#endif
 
 /**
- * @brief Perform a 3 channel cross fade (red, green and blue).
+ * @brief Render a frame of a pattern and present it.
+ * @details With LED_STREAM the pattern is rendered a page at a time, each
+ * page sent while the next is rendered. With LED_PACKED the pages are packed
+ * into a frame of 3 bytes per pixel. With LED_PALETTE the pattern updates
+ * its palette indices, which are expanded a page at a time as they are
+ * sent. With LED_SCROLL a pattern that scrolls moves its frame's offset,
+ * and any other renders the whole frame. Otherwise the frame is rendered
+ * into the back buffer, or for a pattern with a period just the first
+ * period, which is sent repeated along the string. The render time and
+ * the time blocked on the PIO or DMA are added to led_stats.h. The first
+ * frame after a mode change records the time since the button was pressed.
  * 
- * @param pio PIO handle.
- * @param sm State machine id.
- * @param array A pointer to an LED array.
- * @param array_size The size of the LED array.
- * @param red Initial red channel value.
- * @param grn Initial grn channel value.
- * @param blu Initial blu channel value.
- * @param period Cycle period (in ms).
- * @param adj Adjustment rate.
+ * @param pattern The pattern.
+ * @param state The pattern state.
+ * @param t Frame time.
  */
-static void fade_three(PIO pio, int sm, uint32_t *array, size_t array_size, uint8_t red, uint8_t grn, uint8_t blu, uint16_t period, int adj) {
-    
-    // Compute the step for a full transition.
-    uint16_t wait_ms = (((period*10)/256)+5)/10;
-    uint16_t step_count = period / wait_ms;
-        
-    // Define the initial direction that each colour adjusts by.
-    int d_red = (red > 127) ? -adj : adj;
-    int d_grn = (grn > 127) ? -adj : adj;
-    int d_blu = (blu > 127) ? -adj : adj;
-    
-    // Loop until the cycles are zero.
-    uint16_t step_no = 0;
-    while (1) {
-
-        // Early exit if the mode button was pressed.
-        if (get_interrupted()) {
-            break;
-        }
-
-        // Draw the current RGB values - limit brightness to 0-31.
-        uint32_t *ap = array;
-        for (size_t idx = 0; idx < array_size; idx++) {
-            ap[0] = rgb_u32(red>>3, 0, 0);
-            ap[1] = rgb_u32(0, grn>>3, 0);
-            ap[2] = rgb_u32(0, 0, blu>>3);
-            ap += 3;
-        }
-        led_array_write(pio, sm, array, array_size);
-
-        // Adjust the colours according to their directions.
-        red += d_red;
-        grn += d_grn;
-        blu += d_blu;
-
-        // Check for maximum and minimum.
-        d_red = (red == 255) ? -1 : (red == 0) ? 1 : d_red;
-        d_grn = (grn == 255) ? -1 : (grn == 0) ? 1 : d_grn;
-        d_blu = (blu == 255) ? -1 : (blu == 0) ? 1 : d_blu;
-
-        // Adjust the remaining cycles (if above zero).
-        step_no++;
-        if (step_no >= step_count) {
-            step_no = 0;
-        }
+static void show_frame(const led_pattern_t *pattern, led_pattern_state_t *state, uint32_t t) {
+    uint32_t start_us = time_us_32();
+    uint32_t stalled_us = led_stats_stalled();
+#if LED_STREAM
+    pattern->step(state, NULL, NUM_LEDS, t);
+    if (pattern->tile == NULL && pattern->pixel != NULL) {
+        led_stream_frame(pattern->pixel, state, NUM_LEDS, t);
+    }
+    else {
+        led_stream_tiles((pattern->tile != NULL) ? pattern->tile : black_tile, state, NUM_PERPAGE, NUM_LEDS, t);
+    }
+#elif LED_PACKED
+    pattern->step(state, NULL, NUM_LEDS, t);
+    led_packed_frame((pattern->tile != NULL) ? pattern->tile : black_tile, state, NUM_PERPAGE, t);
+#elif LED_PALETTE
+    pattern->step(state, NULL, NUM_LEDS, t);
+    if (pattern->indexed != NULL) {
+        pattern->indexed(state, led_palette_frame(), NUM_LEDS, t);
+    }
+    led_palette_send(NUM_PERPAGE);
+#elif LED_SCROLL
+    uint32_t *frame = led_scroll_frame();
+    size_t offset = 0;
+    if (pattern->scroll != NULL) {
+        pattern->step(state, NULL, NUM_LEDS, t);
+        offset = pattern->scroll(state, frame, NUM_LEDS, t);
+    }
+    else {
+        pattern->step(state, frame, NUM_LEDS, t);
 
-        // Wait for a moment while the LEDs display the selected colour.
-        else {
-            sleep_ms(wait_ms);
+        // The encode reads the frame, so any fills step() queued must end.
+        led_bufops_wait();
+        led_wire_encode(frame, frame, NUM_LEDS);
+    }
+    led_scroll_show(offset);
+#else
+    if (pattern->period > 0 && pattern->period <= LED_DMA_REPEAT_WORDS && pattern->tile != NULL) {
+        led_wire_t tile[LED_DMA_REPEAT_WORDS];
+        pattern->step(state, NULL, NUM_LEDS, t);
+        pattern->tile(state, tile, 0, pattern->period, t);
+        led_wire_encode(tile, tile, pattern->period);
+        led_frames_repeat(tile, pattern->period);
+    }
+    else {
+        pattern->step(state, led_frames_back(), NUM_LEDS, t);
+        led_frames_swap();
+    }
+#endif
+    stalled_us = led_stats_stalled() - stalled_us;
+    led_stats_add(LED_STATS_RENDER, time_us_32() - start_us - stalled_us);
+    led_stats_add(LED_STATS_BLOCKED, stalled_us);
+    led_stats_frame();
+    if (led_switch_start != 0) {
+        led_switch_us = (uint32_t) absolute_time_diff_us(led_switch_start, get_absolute_time());
+        if (led_switch_us > led_switch_max_us) {
+            led_switch_max_us = led_switch_us;
         }
+        led_switch_start = 0;
     }
 }
 
 /**
- * @brief Step the position of a sequence of three LEDs around the array.
+ * @brief Set the LED array to off.
  * 
- * @param pio PIO handle.
- * @param sm State machine id.
- * @param array A pointer to an LED array.
- * @param array_size The size of the LED array.
- * @param period Cycle period (in ms).
+ * @param array_size The number of LEDs in the array buffer.
  */
-static void step_three(PIO pio, int sm, uint32_t *array, size_t array_size, uint16_t period) {
-    
-    // Compute the step for a full transition (divide by 2 because of the PIO delay).
-    uint16_t wait_ms = (((period*10)/255)+5)/10;
-    uint16_t step_count = period / (wait_ms << 1u);
-
-    // Inner loop.
-    int clr_index = 0;
-    uint8_t clr_value = 0;
-    while (1) {
-
-        // Early exit if the mode button was pressed.
-        if (get_interrupted()) {
-            break;
-        }        
-        
-        switch (clr_index) {
-            default:
-            case 0:
-                led_array_set(array, array_size, rgb_u32(clr_value>>3, 0, 0));
-                break;
-            case 1:
-                led_array_set(array, array_size, rgb_u32(0, clr_value>>3, 0));
-                break;
-            case 2:
-                led_array_set(array, array_size, rgb_u32(0,0, clr_value>>3));
-                break;
-        }
-        led_array_write(pio, sm, array, array_size);
-        
-        clr_value++;
-        if (clr_value == 255) {
-            clr_value = 0;
-            clr_index++;
-            if (clr_index > 2) {
-                clr_index = 0;
-            }
-        }
-        sleep_ms(wait_ms);
-    }
+static inline void clear_leds(size_t array_size) {
+#if LED_STREAM
+    led_stream_tiles(black_tile, NULL, NUM_PERPAGE, array_size, 0);
+#elif LED_PACKED
+    led_packed_frame(black_tile, NULL, NUM_PERPAGE, 0);
+#elif LED_PALETTE
+    memset(led_palette_frame(), 0, array_size);
+    led_palette_set(0, 0);
+    led_palette_send(NUM_PERPAGE);
+#elif LED_SCROLL
+    led_bufops_fill(led_scroll_frame(), led_wire_from_pixel(0), array_size);
+    led_scroll_show(0);
+#else
+    led_wire_t black = led_wire_from_pixel(0);
+    led_frames_repeat(&black, 1);
+#endif
 }
 
 /**
- * @brief Walk three colours along the string of LEDs.
+ * @brief Set up a pattern and start its frame deadlines and animation clock.
+ * @details Rendering starts early enough before each deadline to present
+ * the frame on time, by the pattern's estimate of its render time, and the
+ * clock reads ahead by the same time so each frame is drawn for when it is
+ * shown. The timing and frame counters are cleared, so each report covers
+ * this pattern only.
  * 
- * @param pio PIO handle.
- * @param sm State machine id.
- * @param array A pointer to an LED array.
- * @param array_size The size of the LED array.
- * @param period The time between steps.
+ * @param state The pattern state to initialise.
+ * @param mode Index into led_patterns[].
+ * @return const led_pattern_t* The pattern.
  */
-static void walk_three(PIO pio, int sm, uint32_t *array, size_t array_size, uint16_t period) {
+static const led_pattern_t *start_pattern(led_pattern_state_t *state, int mode) {
+    const led_pattern_t *pattern = &led_patterns[mode];
+    uint32_t render_us = (uint32_t) ((pattern->cost_ns * (uint64_t) NUM_LEDS) / 1000u);
+    uint32_t frame_us = render_us + NUM_PIXELS * LED_DMA_WORD_US + LED_DMA_LATCH_US;
+    printf("led mode %d: %s at %u fps, frame about %lu of %lu us\n", mode, pattern->name,
+        pattern->fps, (unsigned long) frame_us, (unsigned long) (1000000u / pattern->fps));
+    if (pattern->init != NULL) {
+        pattern->init(state, pattern->params);
+    }
+    led_sched_start(pattern->fps, render_us);
+    led_anim_start(render_us);
+    led_stats_reset();
+#if LED_STREAM == 0
+    led_frames_reset_stats();
+#endif
+    return pattern;
+}
 
-    // Establish the colours.
-    uint32_t red = rgb_u32(255>>3, 0, 0);
-    uint32_t grn = rgb_u32(0, 255>>3, 0);
-    uint32_t blu = rgb_u32(0, 0, 255>>3);
+/**
+ * @brief Print how well a pattern is keeping to its frame rate and where
+ * its frame time goes.
+ * 
+ * @param mode Index into led_patterns[].
+ * @param histograms True to add the frame timing histograms.
+ */
+static void print_stats(int mode, bool histograms) {
+    led_sched_stats_t stats;
+
+    led_sched_get_stats(&stats);
+    printf("led mode %d: %lu frames at %lu fps, %lu missed, worst %lu us late\n", mode,
+        (unsigned long) stats.frames, (unsigned long) stats.fps,
+        (unsigned long) stats.missed, (unsigned long) stats.late_max_us);
+    printf("led mode %d: press to first frame %lu us (worst %lu us)\n", mode,
+        (unsigned long) led_switch_us, (unsigned long) led_switch_max_us);
+
+#if LED_STREAM == 0
+    led_frames_stats_t frames;
+    led_frames_get_stats(&frames);
+    printf("led frames: %lu sent, %lu unchanged and skipped\n",
+        (unsigned long) frames.sent, (unsigned long) frames.skipped);
+#endif
+    led_stats_dump(histograms);
+}
 
-    // Inner loop.
-    uint8_t step = 0;
-    uint32_t clrs[3];
-    while (1) {
+/**
+ * @brief Stop a pattern and report how well it kept to its frame rate.
+ * 
+ * @param mode Index into led_patterns[].
+ */
+static void report_pattern(int mode) {
+    led_sched_stop();
+    print_stats(mode, false);
+}
 
-        // Early exit if the mode button was pressed.
-        if (get_interrupted()) {
-            break;
-        }
+/**
+ * @brief Print the timing profile in use and how closely it is met.
+ */
+static void print_timing(void) {
+    printf("LED timing %s: T0H %lu ns, T1H %lu ns, bit %lu ns (T1/T2/T3 %u/%u/%u, divider %u)\n", led_profile->name,
+        (unsigned long) led_timing.t0h_ns, (unsigned long) led_timing.t1h_ns, (unsigned long) led_timing.bit_ns,
+        led_timing.t1, led_timing.t2, led_timing.t3, led_timing.div);
+}
 
-        // Set the colours by step.
-        if (step == 0) {
-            clrs[0] = red;
-            clrs[1] = grn;
-            clrs[2] = blu;
-            step = 1;
-        }
-        else if (step == 1) {
-            clrs[2] = red;
-            clrs[0] = grn;
-            clrs[1] = blu;
-            step = 2;
-        }
-        else {
-            clrs[1] = red;
-            clrs[2] = grn;
-            clrs[0] = blu;
-            step = 0;
-        }
-    
-        // Update the colours.
-        for (size_t i = 0; i < array_size; i++) {
-            array[i] = clrs[i % 3];
-        }
+/**
+ * @brief Start the state machine on the loaded program.
+ * @details Runs at the divider of the timing profile when there is one,
+ * otherwise at the assembled timing's 800 kHz.
+ * 
+ * @param pio The PIO.
+ * @param sm The state machine.
+ * @param offset Where the program is loaded.
+ * @param pin_base The first pin.
+ */
+static void init_program(PIO pio, uint sm, uint offset, uint pin_base) {
+#if NUM_STRIPS > 1
+    if (led_profile != NULL) {
+        ws2812_parallel_program_init_clkdiv(pio, sm, offset, pin_base, NUM_STRIPS, led_timing.div, 0);
+    }
+    else {
+        ws2812_parallel_program_init(pio, sm, offset, pin_base, NUM_STRIPS, 800000);
+    }
+#elif LED_PACKED
+    if (led_profile != NULL) {
+        ws2812_packed_program_init_clkdiv(pio, sm, offset, pin_base, led_timing.div, 0);
+    }
+    else {
+        ws2812_packed_program_init(pio, sm, offset, pin_base, 800000);
+    }
+#else
+    if (led_profile != NULL) {
+        ws2812_program_init_clkdiv(pio, sm, offset, pin_base, led_timing.div, 0, false);
+    }
+    else {
+        ws2812_program_init(pio, sm, offset, pin_base, 800000, false);
+    }
+#endif
+}
 
-        // Write out the colours.
-        led_array_write(pio, sm, array, array_size);
-        sleep_ms(period);
+/**
+ * @brief Set the DMA word time from the timing profile, for the latch hold.
+ * @details Replaces the default, or the one led_parallel_init() set. A
+ * parallel word is one bit of every string, not a pixel.
+ * 
+ * @param use_dma True if frames are sent by DMA.
+ */
+static void set_word_time(bool use_dma) {
+    if (use_dma && led_profile != NULL) {
+        uint32_t word_bits = (NUM_STRIPS > 1) ? 1u : 24u;
+        led_dma_set_word_us((led_timing.bit_ns * word_bits + 999u) / 1000u);
     }
 }
 
 /**
- * @brief Walk three colours along the string of LEDs.
+ * @brief Switch to the next timing profile that can be met.
+ * @details The frame on the wire is let finish and latch, then the program
+ * is unloaded, patched with the new delays and loaded back at the same
+ * offset, which it fits as every profile has the same instructions. The
+ * state machine restarts at the new divider.
  * 
- * @param pio PIO handle.
- * @param sm State machine id.
- * @param array A pointer to an LED array.
- * @param array_size The size of the LED array.
- * @param period The time between steps.
- * @param bg_on True for colour background, false for black.
+ * @param pio The PIO.
+ * @param sm The state machine.
+ * @param offset Where the program is loaded.
+ * @param pin_base The first pin.
+ * @param assembled The program as assembled.
+ * @param use_dma True if frames are sent by DMA.
  */
-static void chase_colour(PIO pio, int sm, uint32_t *array, size_t array_size, uint16_t period, bool bg_on) {
-    
-    // Clear the array.
-    clear_leds(pio, sm, array, array_size);
-    
-    // Start the run with red, then green then blue.
-    int clr_pos = 0;
-    uint8_t clr_id = 'r';
-    int clr_dir = 1;
-    while (1) {
-        
-        // Early exit if the mode button was pressed.
-        if (get_interrupted()) {
-            break;
-        }
-        
-        // Create a colour code from the colour id.
-        uint32_t clr_fg, clr_bg;
-        if (clr_id == 'r') {
-            clr_fg = 0x0f0000u;
-            clr_bg = bg_on ? 0x000201u : 0;
-        }
-        else if (clr_id == 'g') {
-            clr_fg = 0x000f00u;
-            clr_bg = bg_on ? 0x010002u : 0;
+static void next_timing(PIO pio, uint sm, uint offset, uint pin_base, const pio_program_t *assembled, bool use_dma) {
+    size_t index = (led_profile != NULL) ? (size_t) (led_profile - led_timing_profiles) : led_timing_profiles_count - 1u;
+    const led_timing_profile_t *profile = NULL;
+    led_timing_t timing;
+    for (size_t tries = 0; tries < led_timing_profiles_count && profile == NULL; tries++) {
+        index = (index + 1u) % led_timing_profiles_count;
+        if (led_timing_solve(&led_timing_profiles[index], clock_get_hz(clk_sys), NUM_STRIPS > 1, &timing)) {
+            profile = &led_timing_profiles[index];
         }
         else {
-            clr_fg = 0x00000fu;
-            clr_bg = bg_on ? 0x020100u : 0;
+            printf("LED timing %s cannot be met, skipped\n", led_timing_profiles[index].name);
         }
+    }
+    if (profile == NULL || profile == led_profile) {
+        return;
+    }
 
-        // Clear the array, setting the indexed colour only.
-        for (size_t idx = 0; idx < array_size; idx++) {
-            if (idx == clr_pos) {
-                array[idx] = clr_fg;
-            }
-            else {
-                array[idx] = clr_bg;
-            }
-        }
-        // Write the array to the LEDs.
-        led_array_write(pio, sm, array, array_size);
-
-        // Advance the position.
-        if (clr_dir == 1) {
-            clr_pos++;
-            if (clr_pos == array_size) {
-                clr_dir = -1;
-                clr_pos--;
-            }
-        }
-        else if (clr_dir == -1) {
-            clr_pos--;
-            if (clr_pos < 0) {
-                clr_pos = 0;
-                clr_dir = 1;
-                switch (clr_id) {
-                    default:
-                    case 'r':
-                        clr_id = 'g';
-                        break;
-                    case 'g':
-                        clr_id = 'b';
-                        break;
-                    case 'b':
-                        clr_id = 'r';
-                        break;
-                }
-            }
-        }
-        sleep_ms(period);
+    // Let the last frame finish and latch before the state machine stops.
+#if (LED_STREAM || LED_PACKED || LED_PALETTE || LED_SCROLL) == 0
+    led_frames_flush();
+#endif
+    if (use_dma) {
+        led_dma_wait();
     }
+    while (pio_sm_is_tx_fifo_empty(pio, sm) == false) {
+        tight_loop_contents();
+    }
+    sleep_us(LED_DMA_WORD_US + LED_DMA_LATCH_US);
+
+    // Reload the program with the new delays.
+    pio_sm_set_enabled(pio, sm, false);
+    pio_remove_program(pio, assembled, offset);
+    led_profile = profile;
+    led_timing = timing;
+    led_timing_patch(&led_program, led_instructions, assembled, NUM_STRIPS > 1, &led_timing);
+    pio_add_program_at_offset(pio, &led_program, offset);
+    init_program(pio, sm, offset, pin_base);
+    set_word_time(use_dma);
+    print_timing();
 }
 
 /**
@@ -433,64 +452,160 @@ int main() {
     PIO pio;
     uint sm;
     uint offset;
-    printf("Setup WS2812b, using pin %d\n", LED_PIN);
-    bool success = pio_claim_free_sm_and_add_program_for_gpio_range(&ws2812_program, &pio, &sm, &offset, LED_PIN, 1, true);
+#if NUM_STRIPS > 1
+    const pio_program_t *assembled = &ws2812_parallel_program;
+    uint pin_base = STRIP_PIN;
+#else
+    const pio_program_t *assembled = &ws2812_program;
+    uint pin_base = LED_PIN;
+#endif
+
+    // Fit the timing profile to clk_sys and set the program's delays to match.
+    const led_timing_profile_t *profile = led_timing_find(LED_TIMING_NAME);
+    if (profile == NULL) {
+        printf("No LED timing profile %s, using %s\n", LED_TIMING_NAME, led_timing_profiles[0].name);
+        profile = &led_timing_profiles[0];
+    }
+    const pio_program_t *program = &led_program;
+    if (led_timing_solve(profile, clock_get_hz(clk_sys), NUM_STRIPS > 1, &led_timing)) {
+        led_profile = profile;
+        led_timing_patch(&led_program, led_instructions, assembled, NUM_STRIPS > 1, &led_timing);
+        print_timing();
+    }
+    else {
+        printf("LED timing %s cannot be met, using the assembled timing\n", profile->name);
+        program = assembled;
+    }
+
+    printf("Setup WS2812b, using %d pin(s) from %u\n", NUM_STRIPS, pin_base);
+    bool success = pio_claim_free_sm_and_add_program_for_gpio_range(program, &pio, &sm, &offset, pin_base, NUM_STRIPS, true);
     if (success == false) {
-        printf("Failed to initialise PIO for program on pin %d\n", LED_PIN);
+        printf("Failed to initialise PIO for program on pin %u\n", pin_base);
     }
     else {        
-        // Allocate a buffer for the colour data.
-        size_t array_size = sizeof(uint32_t) * NUM_PIXELS;
-        uint32_t *led_array = calloc(sizeof(uint32_t), NUM_PIXELS);
-        if (led_array == NULL) {
+        // Initialise the WS2812b LED array as RGB only.
+        init_program(pio, sm, offset, pin_base);
+        bool use_dma = false;
+#if LED_USE_DMA
+        use_dma = led_dma_init(pio, sm);
+        if (use_dma == false) {
+            puts("No DMA channel, using blocking writes");
+        }
+        if (led_bufops_init() == false) {
+            puts("No DMA channel for buffer operations, using the CPU");
+        }
+#endif
+
+        // Parallel strings are transposed into their own buffer as they are
+        // sent, so only the single pin output queues frames for DMA.
+        bool queue_frames = use_dma && (NUM_STRIPS == 1);
+#if NUM_STRIPS > 1
+        success = led_parallel_init(pio, sm, NUM_STRIPS, NUM_PIXELS, use_dma);
+#endif
+
+        // A solved profile sets the word time for the latch hold.
+        set_word_time(use_dma);
+
+        // Allocate the buffers for the colour data.
+#if LED_STREAM
+        (void) queue_frames;
+        if (success == false) {
+            puts("Failed to start the LED stream!");
+        }
+        else {
+            led_stream_init(pio, sm, use_dma);
+            printf("Streaming %lu pixels as %lu pages of %lu, with no frame buffers\n", (unsigned long) NUM_LEDS,
+                (unsigned long) NUM_PAGES, (unsigned long) NUM_PERPAGE);
+#elif LED_PACKED
+        (void) queue_frames;
+        if (success == false || led_packed_init(pio, sm, NUM_LEDS, use_dma) == false) {
             puts("Failed to allocate a LED array!");
         }
         else {
-            printf("Allocated %u x %u = %lu bytes for a LED array\n", sizeof(uint32_t), NUM_PIXELS, array_size);
-
-            // Initialise the WS2812b LED array as RGB only.
-            ws2812_program_init(pio, sm, offset, LED_PIN, 800000, false);
-            clear_leds(pio, sm, led_array, NUM_PIXELS);
+            printf("Allocated %d x %lu bytes for the packed LED frames\n", use_dma ? 2 : 1,
+                (unsigned long) (LED_PACKED_WORDS(NUM_LEDS) * sizeof(uint32_t)));
+#elif LED_PALETTE
+        (void) queue_frames;
+        if (success == false || led_palette_init(NUM_LEDS) == false) {
+            puts("Failed to allocate a LED array!");
+        }
+        else {
+            led_stream_init(pio, sm, use_dma);
+            printf("Allocated %lu bytes for the LED palette indices\n", (unsigned long) NUM_LEDS);
+#elif LED_SCROLL
+        (void) queue_frames;
+        if (success == false || led_scroll_init(pio, sm, NUM_LEDS, use_dma) == false) {
+            puts("Failed to allocate a LED array!");
+        }
+        else {
+            printf("Allocated %lu x %lu bytes for the scrolled LED frame\n", (unsigned long) sizeof(uint32_t), (unsigned long) NUM_LEDS);
+#else
+        if (success == false || led_frames_init(pio, sm, NUM_FRAMES, NUM_LEDS, queue_frames) == false) {
+            puts("Failed to allocate a LED array!");
+        }
+        else {
+#if NUM_STRIPS > 1
+            led_frames_set_writer(led_parallel_write);
+#endif
+            printf("Allocated %d x %lu x %lu bytes for the LED frames\n", (queue_frames || LED_DUAL_CORE) ? NUM_FRAMES : 1,
+                (unsigned long) sizeof(uint32_t), (unsigned long) NUM_LEDS);
+            printf("Rendering on core 0, sending on core %d\n", LED_DUAL_CORE ? 1 : 0);
+#endif
+            clear_leds(NUM_LEDS);
+            puts("Press a key on the console for the frame timing, or t for the next timing profile");
             sleep_ms(1000);
 
-            // Endless loop.
-            // clear_leds(pio, sm, led_array, NUM_PIXELS);
+            // Endless loop, one frame per pass.
+            led_pattern_state_t state;
+            const led_pattern_t *pattern = start_pattern(&state, led_pattern);
             while(1) {
 
-                printf("led mode %d\n", led_pattern);
-                switch(led_pattern) {
-                    case MODE_CHASE_THREE:
-                        // Tripple chaser with 100ms separation.
-                        walk_three(pio, sm, led_array, NUM_PIXELS, 100);
-                        break;
-                    case MODE_CROSS_FADE_ONE:
-                        // Slow fade over 3 seconds.
-                        fade_three(pio, sm, led_array, NUM_PIXELS, 255, 0, 127, 3000, 1);
-                        break;
-                    case MODE_CHASE_THREE_SLOW:
-                        // Tripple chaser with 200ms separation.
-                        walk_three(pio, sm, led_array, NUM_PIXELS, 200);
-                        break;
-                    case MODE_CROSS_FADE_TWO:
-                        // Quick pulse with 3 second duration.
-                        fade_three(pio, sm, led_array, NUM_PIXELS, 255, 0, 127, 3000, 2);
-                        break;
-                    case MODE_COLOUR_CHASE_BLACK:
-                        // Colour chaser.
-                        chase_colour(pio, sm, led_array, NUM_PIXELS, 30, false);
-                        break;
-                    case MODE_COLOUR_CHASE_COLOUR:
-                        // Colour chaser.
-                        chase_colour(pio, sm, led_array, NUM_PIXELS, 30, true);
-                        break;
+                // Move on to the next mode when the button is pressed.
+                if (get_interrupted()) {
+                    report_pattern(led_pattern);
+                    led_pattern = (led_pattern + 1) % led_patterns_count;
+                    pattern = start_pattern(&state, led_pattern);
+                }
+
+                // Switch the timing profile when t is typed on the console,
+                // or dump the frame timing for any other key.
+                int key = getchar_timeout_us(0);
+                if (key == 't') {
+                    next_timing(pio, sm, offset, pin_base, assembled, use_dma);
                 }
+                else if (key != PICO_ERROR_TIMEOUT) {
+                    print_stats(led_pattern, true);
+                }
+
+                // Render and present this frame for the time it will be
+                // shown, then wait for the next.
+                show_frame(pattern, &state, led_anim_ms());
+                led_sched_wait();
             }
             // free up resources.
-            puts("Releasing LED array buffer");
-            free(led_array);
+#if LED_PACKED
+            puts("Releasing LED array buffers");
+            led_packed_deinit();
+#elif LED_PALETTE
+            puts("Releasing LED array buffers");
+            led_palette_deinit();
+#elif LED_SCROLL
+            puts("Releasing LED array buffers");
+            led_scroll_deinit();
+#elif LED_STREAM == 0
+            puts("Releasing LED array buffers");
+            led_frames_deinit();
+#endif
+        }
+#if NUM_STRIPS > 1
+        led_parallel_deinit();
+#endif
+        led_bufops_deinit();
+        if (use_dma) {
+            led_dma_deinit();
         }
         // This will free resources and unload our program
-        pio_remove_program_and_unclaim_sm(&ws2812_program, pio, sm, offset);
+        pio_remove_program_and_unclaim_sm(program, pio, sm, offset);
     }
 
     puts("Exiting and rebooting.");